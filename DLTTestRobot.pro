@@ -1,24 +1,58 @@
-QT       += core gui serialport network
+QT       += core gui serialport network concurrent sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++2a
+
+# the lanes of the test robot are C++20 coroutines
+linux-g++*: QMAKE_CXXFLAGS += -fcoroutines
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    dltlogmodel.cpp \
+    dltmessageencoder.cpp \
     dltminiserver.cpp \
+    dltperformancemonitor.cpp \
+    dltreportsummary.cpp \
+    dltreportwriter.cpp \
+    dltrundatabase.cpp \
+    dlttestcommandmodel.cpp \
+    dlttestcoordinator.cpp \
+    dlttesthistory.cpp \
+    dlttestreport.cpp \
+    dlttestresultwriter.cpp \
     dlttestrobot.cpp \
+    dlttestrunner.cpp \
+    dlttimeoutmanager.cpp \
+    dlttimeserieswriter.cpp \
+    dlttimingstatistics.cpp \
     main.cpp \
     dialog.cpp \
     settingsdialog.cpp
 
 HEADERS += \
     dialog.h \
+    dltlanetask.h \
+    dltlogmodel.h \
+    dltmessageencoder.h \
     dltminiserver.h \
+    dltperformancemonitor.h \
+    dltreportsummary.h \
+    dltreportwriter.h \
+    dltrundatabase.h \
+    dlttestcommandmodel.h \
+    dlttestcoordinator.h \
+    dlttesthistory.h \
+    dlttestreport.h \
+    dlttestresultwriter.h \
     dlttestrobot.h \
+    dlttestrunner.h \
+    dlttimeoutmanager.h \
+    dlttimeserieswriter.h \
+    dlttimingstatistics.h \
     settingsdialog.h \
     version.h
 
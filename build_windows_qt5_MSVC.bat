@@ -131,6 +131,9 @@ if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 mkdir %INSTALLATION_DIR%\platforms
 if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 
+mkdir %INSTALLATION_DIR%\sqldrivers
+if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
+
 mkdir %INSTALLATION_DIR%\doc
 if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 
@@ -165,9 +168,18 @@ if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 copy %QTDIR%\bin\Qt5SerialPort.dll %INSTALLATION_DIR%
 if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 
+copy %QTDIR%\bin\Qt5Concurrent.dll %INSTALLATION_DIR%
+if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
+
+copy %QTDIR%\bin\Qt5Sql.dll %INSTALLATION_DIR%
+if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
+
 copy %QTDIR%\plugins\platforms\qwindows.dll %INSTALLATION_DIR%\platforms
 if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 
+copy %QTDIR%\plugins\sqldrivers\qsqlite.dll %INSTALLATION_DIR%\sqldrivers
+if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
+
 copy %BUILD_DIR%\%NAME%.exe %INSTALLATION_DIR%
 if %ERRORLEVEL% NEQ 0 GOTO ERROR_HANDLER
 
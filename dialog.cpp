@@ -17,6 +17,8 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QDir>
+#include <QTimer>
+#include <QDebug>
 
 #include "dialog.h"
 #include "ui_dialog.h"
@@ -27,9 +29,13 @@ Dialog::Dialog(bool autostart,QString configuration,QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::Dialog)
     , dltTestRobot(this)
+    , testReport(&dltTestRobot,&dltMiniServer)
+    , performanceMonitor(&dltTestRobot,&testReport)
 {
     ui->setupUi(this);
 
+    autorun = false;
+
     // clear settings
     on_pushButtonDefaultSettings_clicked();
 
@@ -40,11 +46,24 @@ Dialog::Dialog(bool autostart,QString configuration,QWidget *parent)
     // disable stop button at startup
     ui->pushButtonStop->setDisabled(true);
 
+    // command list and UI update rate of 25 Hz
+    ui->listViewCommands->setModel(&commandModel);
+    ui->listViewCommands->setUniformItemSizes(true);
+    uiTimer.setInterval(40);
+    connect(&uiTimer, SIGNAL(timeout()), this, SLOT(updateUi()));
+
+    // live log of received DLT messages, filtered by the test robot
+    ui->listViewLog->setModel(&logModel);
+    connect(&dltTestRobot, SIGNAL(received(QStringList)), &logModel, SLOT(addLines(QStringList)));
+    connect(&logModel, SIGNAL(inserted()), ui->listViewLog, SLOT(scrollToBottom()));
+
+    // performance of the test robot updated every second
+    connect(&performanceMonitor, SIGNAL(updated(QString)), ui->labelPerformance, SLOT(setText(QString)));
+    performanceMonitor.start();
+
     // connect status slots
     connect(&dltTestRobot, SIGNAL(status(QString)), this, SLOT(statusTestRobot(QString)));
     connect(&dltTestRobot, SIGNAL(statusTests(QString)), this, SLOT(statusTests(QString)));
-    connect(&dltTestRobot, SIGNAL(report(QString)), this, SLOT(report(QString)));
-    connect(&dltTestRobot, SIGNAL(reportSummary(QString)), this, SLOT(reportSummary(QString)));
     connect(&dltMiniServer, SIGNAL(status(QString)), this, SLOT(statusDlt(QString)));
 
     connect(&dltTestRobot, SIGNAL(command(int,int,int,int,int,int,int,QString)), this, SLOT(command(int,int,int,int,int,int,int,QString)));
@@ -220,6 +239,10 @@ void Dialog::statusTests(QString text)
         ui->lineEditCurrentCommand->setPalette(palette);
         ui->lineEditCurrentCommand->setText(text);
 
+        // show the final state
+        uiTimer.stop();
+        updateUi();
+
         // close DLT file and disconnect ECUs
         dltTestRobot.send(QString("disconnectAllEcu"));
         dltTestRobot.send(QString("clearFile"));
@@ -230,8 +253,17 @@ void Dialog::statusTests(QString text)
         ui->pushButtonTestLoad->setEnabled(true);
         ui->comboBoxTestName->setEnabled(true);
         ui->checkBoxRunAllTest->setEnabled(true);
+        ui->checkBoxResume->setEnabled(true);
+        ui->checkBoxDetailLog->setEnabled(true);
+        ui->checkBoxDltFile->setEnabled(true);
+        ui->checkBoxOrderByHistory->setEnabled(true);
+        ui->lineEditMaxFailures->setEnabled(true);
         ui->lineEditRepeat->setEnabled(true);
         ui->pushButtonStop->setEnabled(true);
+
+        // exit with failure, when any test failed in a run without user interaction
+        if(autorun)
+            QCoreApplication::exit(testReport.exitCode());
     }
 }
 
@@ -267,19 +299,6 @@ void Dialog::statusDlt(QString text)
     }
 }
 
-void Dialog::report(QString text)
-{
-    // write to report
-    QTime time = QTime::currentTime();
-    reportFile.write(QString("=> %1 %2\n").arg(time.toString("HH:mm:ss")).arg(text).toLatin1());
-}
-
-void Dialog::reportSummary(QString text)
-{
-    // write to report
-    reportSummaryList.append(text);
-}
-
 void Dialog::on_pushButtonDefaultSettings_clicked()
 {
     // Reset settings to default
@@ -395,7 +414,7 @@ void Dialog::on_pushButtonTestLoad_clicked()
     // Load test file
 
     QString fileName = QFileDialog::getOpenFileName(this,
-        tr("Open Tests"), "", tr("DLTTestRobot Tests (*.dtr);;All files (*.*)"));
+        tr("Open Tests"), "", tr("DLTTestRobot Tests (*.dtr *.dts);;All files (*.*)"));
 
     if(fileName.isEmpty())
     {
@@ -409,14 +428,22 @@ void Dialog::on_pushButtonTestLoad_clicked()
     loadTests(fileName);
 }
 
-void Dialog::loadTests(QString fileName)
+void Dialog::loadTests(QString fileName, bool showResult)
 {
     ui->lineEditTestFile->setText(fileName);
 
     // read the tests from dtr file
     QStringList errors = dltTestRobot.readTests(fileName);
 
-    if(!errors.isEmpty())
+    // history, checkpoint and run database
+    dltTestRobot.setReportDirectory("reports");
+
+    if(!showResult)
+    {
+        if(!errors.isEmpty())
+            qDebug() << "Loading Test Cases failed:" << errors;
+    }
+    else if(!errors.isEmpty())
     {
         // There are some error during parsing test file
         QMessageBox msgBox(QMessageBox::Critical,"Loading Test Cases","");
@@ -438,6 +465,58 @@ void Dialog::loadTests(QString fileName)
     }
 }
 
+void Dialog::setViewer(const QString &host, unsigned short port)
+{
+    if(!host.isEmpty())
+        dltTestRobot.setHost(host);
+    if(port!=0)
+        dltTestRobot.setPort(port);
+}
+
+void Dialog::setServerPort(unsigned short port)
+{
+    // overrides the DLT Mini Server port of the configuration, each instance on a host needs its own port
+    if(port!=0)
+        dltMiniServer.setPort(port);
+}
+
+void Dialog::setShard(int index, int count)
+{
+    dltTestRobot.setShard(index,count);
+}
+
+void Dialog::runTests(const QString &testsFilename, int repeat, const QString &reportFilename)
+{
+    autorun = true;
+    autorunReportFilename = reportFilename;
+
+    // start communication, if not already started by autostart
+    if(ui->pushButtonStart->isEnabled())
+        on_pushButtonStart_clicked();
+    if(!dltMiniServer.isListening())
+        qDebug() << "DLT Mini Server cannot listen on port" << dltMiniServer.getPort() << ", no test events are sent";
+
+    loadTests(testsFilename,false);
+
+    if(dltTestRobot.size()==0)
+    {
+        qDebug() << "No tests to run in" << testsFilename;
+        QTimer::singleShot(0,this,SLOT(autorunError()));
+        return;
+    }
+
+    ui->checkBoxRunAllTest->setChecked(true);
+    ui->lineEditRepeat->setText(QString("%1").arg(repeat));
+
+    startTests();
+}
+
+void Dialog::autorunError()
+{
+    // tests could not be started, the event loop is running now
+    QCoreApplication::exit(2);
+}
+
 void Dialog::on_pushButtonStartTest_clicked()
 {
     startTests();
@@ -455,30 +534,18 @@ void Dialog::startTests()
     // update Command Number
     ui->lineEditCmdNo->setText(QString("%1/%2").arg(0).arg(dltTestRobot.testSize(ui->comboBoxTestName->currentIndex())));
 
-    // create and write to report
-    QTime time = QTime::currentTime();
-    QDate date = QDate::currentDate();
-    if(reportFile.isOpen())
-        reportFile.close();
-    reportSummaryList.clear();
-    reportFailedCounter=0;
-    reportSuccessCounter=0;
+    // create report, new DLT file and connect all ECUs
+    QString name;
     if(ui->checkBoxRunAllTest->isChecked())
-        reportFile.setFileName(date.toString("reports\\yyyyMMdd_")+time.toString("HHmmss_")+QFileInfo(dltTestRobot.getTestsFilename()).baseName()+"_TestReport.txt");
+        name = QFileInfo(dltTestRobot.getTestsFilename()).baseName();
     else
-        reportFile.setFileName(date.toString("reports\\yyyyMMdd_")+time.toString("HHmmss_")+dltTestRobot.testId(ui->comboBoxTestName->currentIndex())+"_TestReport.txt");
-    reportFile.open(QIODevice::WriteOnly | QIODevice::Text);
-    reportFile.write(QString("Starting tests at %1 %2\n").arg(date.toString("dd.MM.yyyy")).arg(time.toString("HH:mm:ss")).toLatin1());
-    reportFile.write(QString("\nTest File: %1\n").arg(dltTestRobot.getTestsFilename()).toLatin1());
-    reportFile.write(QString("\nTest Version: %1\n\n").arg(dltTestRobot.getVersion()).toLatin1());
-    reportFile.flush();
-
-    // open new DLt file and connect all ECUs
-    if(ui->checkBoxRunAllTest->isChecked())
-        dltTestRobot.send(QString("newFile ")+QDir::currentPath()+date.toString("\\reports\\yyyyMMdd_")+time.toString("HHmmss_")+QFileInfo(dltTestRobot.getTestsFilename()).baseName()+"_Logs.dlt");
-    else
-        dltTestRobot.send(QString("newFile ")+QDir::currentPath()+date.toString("\\reports\\yyyyMMdd_")+time.toString("HHmmss_")+dltTestRobot.testId(ui->comboBoxTestName->currentIndex())+"_Logs.dlt");
-    dltTestRobot.send(QString("connectAllEcu"));
+        name = dltTestRobot.testId(ui->comboBoxTestName->currentIndex());
+    testReport.open(name,autorunReportFilename,ui->checkBoxDetailLog->isChecked(),ui->checkBoxDltFile->isChecked());
+
+    // update the UI with a fixed rate while the tests are running
+    commandModel.clear();
+    snapshot = Snapshot();
+    uiTimer.start();
 
     // update UI
     ui->pushButtonStartTest->setEnabled(false);
@@ -486,118 +553,83 @@ void Dialog::startTests()
     ui->pushButtonTestLoad->setEnabled(false);
     ui->comboBoxTestName->setEnabled(false);
     ui->checkBoxRunAllTest->setEnabled(false);
+    ui->checkBoxResume->setEnabled(false);
+    ui->checkBoxDetailLog->setEnabled(false);
+    ui->checkBoxDltFile->setEnabled(false);
+    ui->checkBoxOrderByHistory->setEnabled(false);
+    ui->lineEditMaxFailures->setEnabled(false);
     ui->lineEditRepeat->setEnabled(false);
     ui->pushButtonStop->setEnabled(false);
 
     // start the tests and write info to log
-    dltMiniServer.sendValue2("Tests start",QFileInfo(dltTestRobot.getTestsFilename()).baseName());
+    dltTestRobot.setOrderByHistory(ui->checkBoxOrderByHistory->isChecked());
+    dltTestRobot.setMaxFailures(ui->lineEditMaxFailures->text().toInt());
     if(ui->checkBoxRunAllTest->isChecked())
-        dltTestRobot.startTest(-1,ui->lineEditRepeat->text().toInt());
+        dltTestRobot.startTest(-1,ui->lineEditRepeat->text().toInt(),ui->checkBoxResume->isChecked());
     else
-        dltTestRobot.startTest(ui->comboBoxTestName->currentIndex(),ui->lineEditRepeat->text().toInt());
+        dltTestRobot.startTest(ui->comboBoxTestName->currentIndex(),ui->lineEditRepeat->text().toInt(),ui->checkBoxResume->isChecked());
 }
 
-void Dialog::stopTests()
+void Dialog::command(int allTestRepeatNum,int allTestRepeat, int testRepeatNum,int testRepeat,int testNum, int commandNum,int commandCount, QString text)
 {
-    // write summary and close report
-    writeSummaryToReport();
-    reportFile.close();
+    // only store the state, the UI is updated by the UI timer
+    snapshot.allTestRepeatNum = allTestRepeatNum;
+    snapshot.allTestRepeat = allTestRepeat;
+    snapshot.testRepeatNum = testRepeatNum;
+    snapshot.testRepeat = testRepeat;
+    snapshot.commandNum = commandNum;
+    snapshot.commandCount = commandCount;
+    if(text!="end" && text!="stopped")
+        snapshot.testNum = testNum;
+    snapshot.changed = true;
 }
 
-void Dialog::writeSummaryToReport()
+void Dialog::updateUi()
 {
-    // write summary
-    QTime time = QTime::currentTime();
-    QDate date = QDate::currentDate();
-    reportFile.write(QString("\nSummary\n").toLatin1());
-    for(int num=0;num<reportSummaryList.size();num++)
-    {
-        reportFile.write((reportSummaryList[num]+"\n").toLatin1());
-    }
-    reportFile.write(QString("\nSuccess tests: %1\nFailed tests: %2\nFailed test commands: %3\n").arg(reportSuccessCounter).arg(reportFailedCounter).arg(dltTestRobot.getFailedTestCommands()).toLatin1());
-    reportFile.write(QString("\nTests STOPPED at %1 %2\n").arg(date.toString("dd.MM.yyyy")).arg(time.toString("HH:mm:ss")).toLatin1());
-}
+    if(!snapshot.changed)
+        return;
+    snapshot.changed = false;
 
-void Dialog::command(int allTestRepeatNum,int allTestRepeat, int testRepeatNum,int testRepeat,int testNum, int commandNum,int commandCount, QString text)
-{
-    ui->lineEditCmdNo->setText(QString("%1/%2").arg(commandNum+1).arg(commandCount));
-    ui->lineEditRepeatNo->setText(QString("%1/%2").arg(allTestRepeatNum+1).arg(allTestRepeat));
-    ui->lineEditTestRepeatNo->setText(QString("%1/%2").arg(testRepeatNum+1).arg(testRepeat));
-    ui->lineEditCurrentTest->setText(QString("%1 (%2)").arg(dltTestRobot.testId(testNum)).arg(dltTestRobot.testDescription(testNum)));
-    ui->lineEditFailed->setText(QString("%1").arg(dltTestRobot.getFailedTestCommands()));
+    ui->lineEditCmdNo->setText(QString("%1/%2").arg(snapshot.commandNum+1).arg(snapshot.commandCount));
+    ui->lineEditRepeatNo->setText(QString("%1/%2").arg(snapshot.allTestRepeatNum+1).arg(snapshot.allTestRepeat));
+    ui->lineEditTestRepeatNo->setText(QString("%1/%2").arg(snapshot.testRepeatNum+1).arg(snapshot.testRepeat));
+    ui->lineEditCurrentTest->setText(QString("%1 (%2)").arg(dltTestRobot.testId(snapshot.testNum)).arg(dltTestRobot.testDescription(snapshot.testNum)));
 
-    if(dltTestRobot.getFailedTestCommands()>0)
-    {
-        QPalette palette;
-        palette.setColor(QPalette::Base,Qt::red);
-        ui->lineEditFailed->setPalette(palette);
-    }
-    else
+    int failedTestCommands = dltTestRobot.getFailedTestCommands();
+    ui->lineEditFailed->setText(QString("%1").arg(failedTestCommands));
+
+    // the palette is only changed when the failed state changes
+    int failed = failedTestCommands>0?1:0;
+    if(snapshot.failed!=failed)
     {
+        snapshot.failed = failed;
+
         QPalette palette;
-        palette.setColor(QPalette::Base,Qt::green);
+        palette.setColor(QPalette::Base,snapshot.failed?Qt::red:Qt::green);
         ui->lineEditFailed->setPalette(palette);
     }
 
-    if(text=="started")
-    {
-        dltMiniServer.sendValue2("test start",dltTestRobot.testId(testNum));
-        ui->listWidgetCommands->clear();
-        ui->listWidgetCommands->addItems(dltTestRobot.getTest(testNum).getCommands());
-        ui->listWidgetCommands->setCurrentRow(commandNum);
-
-        // write to report
-        QTime time = QTime::currentTime();
-        reportFile.write(QString("\n%1 test start %2 (%3/%4)\n").arg(time.toString("HH:mm:ss")).arg(dltTestRobot.testId(testNum)).arg(testRepeatNum+1).arg(testRepeat).toLatin1());
-        reportFile.flush();
-    }
-    else if(text=="end success")
-    {
-        dltMiniServer.sendValue2("test end success",dltTestRobot.testId(testNum));
-
-        // write to report
-        QTime time = QTime::currentTime();
-        reportFile.write(QString("%1 test end SUCCESS\n").arg(time.toString("HH:mm:ss")).toLatin1());
-        reportFile.flush();
-
-        reportSummaryList.append(QString("SUCCESS %1 (%2/%3)").arg(dltTestRobot.testId(testNum)).arg(testRepeatNum+1).arg(testRepeat));
-        reportSuccessCounter++;
-    }
-    else if(text=="end")
+    // the command list is only rebuilt when another test is shown
+    if(snapshot.testNum>=0 && snapshot.testNum<dltTestRobot.size())
     {
-        dltMiniServer.sendValue2("Tests end",QFileInfo(dltTestRobot.getTestsFilename()).baseName());
-
-        stopTests();
-
+        if(snapshot.testNum!=commandModel.getTestNum())
+            commandModel.setCommands(snapshot.testNum,dltTestRobot.getTest(snapshot.testNum).getExpandedCommands());
+        commandModel.setCurrentRow(snapshot.commandNum);
+        if(snapshot.commandNum>=0 && snapshot.commandNum<commandModel.rowCount())
+            ui->listViewCommands->scrollTo(commandModel.index(snapshot.commandNum));
     }
-    else if(text=="failed")
-    {
-        dltMiniServer.sendValue2("test failed",dltTestRobot.testId(testNum),DLT_LOG_FATAL);
-
-        // write to report
-        QTime time = QTime::currentTime();
-        reportFile.write(QString("%1 test FAILED\n").arg(time.toString("HH:mm:ss")).toLatin1());
-        reportFile.flush();
-
-        reportSummaryList.append(QString("FAILED %1 (%2/%3)").arg(dltTestRobot.testId(testNum)).arg(testRepeatNum+1).arg(testRepeat));
-        reportFailedCounter++;
-        dltTestRobot.send(QString("marker"));
+}
 
-    }
-    else if(text=="stopped")
-    {
-        stopTests();
-    }
-    else
-    {
-        ui->listWidgetCommands->setCurrentRow(commandNum);
-        dltMiniServer.sendValue3("test step",QString("%1").arg(commandNum),text);
+void Dialog::on_checkBoxLiveLog_clicked(bool checked)
+{
+    dltTestRobot.setLogEnabled(checked);
+}
 
-        // write to report
-        QTime time = QTime::currentTime();
-        reportFile.write(QString("%1 test step %2 %3\n").arg(time.toString("HH:mm:ss")).arg(commandNum).arg(text).toLatin1());
-        reportFile.flush();
-    }
+void Dialog::on_lineEditLogFilter_textChanged(const QString &text)
+{
+    // the filter is applied to new messages
+    dltTestRobot.setLogFilter(text);
+    logModel.clear();
 }
 
 void Dialog::on_checkBoxAutoloadTests_clicked(bool checked)
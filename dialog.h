@@ -22,9 +22,14 @@
 #include <QSettings>
 #include <QFile>
 #include <QDateTime>
+#include <QTimer>
 
 #include "dlttestrobot.h"
 #include "dltminiserver.h"
+#include "dlttestreport.h"
+#include "dlttestcommandmodel.h"
+#include "dltlogmodel.h"
+#include "dltperformancemonitor.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class Dialog; }
@@ -38,14 +43,18 @@ public:
     Dialog(bool autostart,QString configuration,QWidget *parent = nullptr);
     ~Dialog();
 
+    // run all tests without user interaction and exit the application when finished
+    void setViewer(const QString &host, unsigned short port);
+    void setServerPort(unsigned short port);
+    void setShard(int index, int count);
+    void runTests(const QString &testsFilename, int repeat, const QString &reportFilename);
+
 private slots:
 
     // Status of Test Robot and DLT connection
     void statusTestRobot(QString text);
     void statusTests(QString text);
     void statusDlt(QString text);
-    void report(QString text);
-    void reportSummary(QString text);
 
     // Settings and Info
     void on_pushButtonSettings_clicked();
@@ -65,29 +74,55 @@ private slots:
     void command(int allTestRepeatNum,int allTestRepeat, int testRepeatNum,int testRepeat,int testNum, int commandNum,int commandCount, QString text);
 
     void on_checkBoxAutoloadTests_clicked(bool checked);
+    void on_checkBoxLiveLog_clicked(bool checked);
+    void on_lineEditLogFilter_textChanged(const QString &text);
 
     void on_pushButtonStopTest_clicked();
 
+    void autorunError();
+
+    void updateUi();
+
 private:
     Ui::Dialog *ui;
 
     DLTTestRobot dltTestRobot;
     DLTMiniServer dltMiniServer;
 
-    QFile reportFile;
-    QStringList reportSummaryList;
-    int reportFailedCounter,reportSuccessCounter;
+    bool autorun;
+    QString autorunReportFilename;
+
+    DLTTestReport testReport;
+    DLTPerformanceMonitor performanceMonitor;
+
+    // state of the tests shown in the UI
+    class Snapshot
+    {
+    public:
+        Snapshot() : allTestRepeatNum(0), allTestRepeat(0), testRepeatNum(0), testRepeat(0), testNum(-1), commandNum(-1), commandCount(0), failed(-1), changed(false) {}
+
+        int allTestRepeatNum;
+        int allTestRepeat;
+        int testRepeatNum;
+        int testRepeat;
+        int testNum;
+        int commandNum;
+        int commandCount;
+        int failed;
+        bool changed;
+    };
+    Snapshot snapshot;
+    QTimer uiTimer;
+    DLTTestCommandModel commandModel;
+    DLTLogModel logModel;
 
     // Settings
     void restoreSettings();
     void updateSettings();
 
-    void loadTests(QString fileName);
+    void loadTests(QString fileName, bool showResult = true);
 
     void startTests();
-    void stopTests();
-
-    void writeSummaryToReport();
 
 };
 #endif // DIALOG_H
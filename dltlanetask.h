@@ -0,0 +1,76 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltlanetask.h
+ * @licence end@
+ */
+#ifndef DLTLANETASK_H
+#define DLTLANETASK_H
+
+#include <coroutine>
+#include <exception>
+
+// Coroutine executing the tests of a lane.
+// The coroutine is created suspended and resumed by the test robot when the lane starts,
+// when an awaited DLT message is received and when an awaited timer expires.
+// The coroutine frame is destroyed with the task, also when the lane is suspended.
+class DLTLaneTask
+{
+public:
+    class promise_type
+    {
+    public:
+        DLTLaneTask get_return_object() { return DLTLaneTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    DLTLaneTask() : handle(nullptr) {}
+    explicit DLTLaneTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    DLTLaneTask(DLTLaneTask &&other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    ~DLTLaneTask() { destroy(); }
+
+    DLTLaneTask &operator=(DLTLaneTask &&other) noexcept
+    {
+        if(this!=&other)
+        {
+            destroy();
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+
+    DLTLaneTask(const DLTLaneTask &) = delete;
+    DLTLaneTask &operator=(const DLTLaneTask &) = delete;
+
+    void resume()
+    {
+        if(handle && !handle.done())
+            handle.resume();
+    }
+
+    bool done() const { return !handle || handle.done(); }
+
+    void destroy()
+    {
+        if(handle)
+            handle.destroy();
+        handle = nullptr;
+    }
+
+private:
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+#endif // DLTLANETASK_H
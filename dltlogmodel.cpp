@@ -0,0 +1,101 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltlogmodel.cpp
+ * @licence end@
+ */
+
+#include "dltlogmodel.h"
+
+DLTLogModel::DLTLogModel(int capacity, QObject *parent) : QAbstractListModel(parent)
+{
+    this->capacity = capacity>0?capacity:1;
+    start = 0;
+    count = 0;
+    ring.resize(this->capacity);
+
+    // insert the collected lines 10 times per second
+    timer.setInterval(100);
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(insertPending()));
+}
+
+void DLTLogModel::clear()
+{
+    timer.stop();
+    pending.clear();
+
+    beginResetModel();
+    start = 0;
+    count = 0;
+    ring.fill(QString());
+    endResetModel();
+}
+
+void DLTLogModel::addLines(QStringList lines)
+{
+    pending.append(lines);
+
+    // only the last lines fit into the buffer
+    if(pending.size()>capacity)
+        pending.erase(pending.begin(),pending.begin()+(pending.size()-capacity));
+
+    if(!timer.isActive())
+        timer.start();
+}
+
+void DLTLogModel::insertPending()
+{
+    if(pending.isEmpty())
+        return;
+
+    int size = pending.size();
+
+    // remove the oldest lines to make space for the new lines
+    int overflow = count+size-capacity;
+    if(overflow>0)
+    {
+        beginRemoveRows(QModelIndex(),0,overflow-1);
+        for(int num=0;num<overflow;num++)
+            ring[(start+num)%capacity].clear();
+        start = (start+overflow)%capacity;
+        count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(),count,count+size-1);
+    for(int num=0;num<size;num++)
+        ring[(start+count+num)%capacity] = pending[num];
+    count += size;
+    endInsertRows();
+
+    pending.clear();
+
+    emit inserted();
+}
+
+int DLTLogModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return count;
+}
+
+QVariant DLTLogModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row()>=count)
+        return QVariant();
+
+    if(role==Qt::DisplayRole)
+        return ring[(start+index.row())%capacity];
+
+    return QVariant();
+}
@@ -0,0 +1,62 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltlogmodel.h
+ * @licence end@
+ */
+
+#ifndef DLTLOGMODEL_H
+#define DLTLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+#include <QVector>
+#include <QTimer>
+
+// Last received lines in a ring buffer with fixed capacity.
+// New lines are collected and inserted in batches, the oldest lines are removed when the buffer is full.
+class DLTLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit DLTLogModel(int capacity = 100000, QObject *parent = nullptr);
+
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // lines waiting to be inserted
+    int pendingSize() const { return pending.size(); }
+
+signals:
+
+    void inserted();
+
+public slots:
+
+    void addLines(QStringList lines);
+
+private slots:
+
+    void insertPending();
+
+private:
+
+    int capacity;
+    int start;
+    int count;
+    QVector<QString> ring;
+
+    QStringList pending;
+    QTimer timer;
+};
+
+#endif // DLTLOGMODEL_H
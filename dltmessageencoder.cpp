@@ -0,0 +1,278 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltmessageencoder.cpp
+ * @licence end@
+ */
+#include "dltmessageencoder.h"
+
+#include <QElapsedTimer>
+
+#include <string.h>
+
+#define DLT_TYPE_INFO_BOOL 0x00000011
+#define DLT_TYPE_INFO_SINT32 0x00000023
+#define DLT_TYPE_INFO_SINT64 0x00000024
+#define DLT_TYPE_INFO_UINT32 0x00000043
+#define DLT_TYPE_INFO_UINT64 0x00000044
+#define DLT_TYPE_INFO_FLOAT32 0x00000083
+#define DLT_TYPE_INFO_FLOAT64 0x00000084
+#define DLT_TYPE_INFO_STRG_UTF8 0x00008200
+
+// standard header (4 bytes) and extended header (10 bytes)
+static const int headerLength = 4+10;
+
+DLTMessageEncoder::DLTMessageEncoder()
+{
+    buffer = new char[maxLength];
+    length = 0;
+    arguments = 0;
+    counter = 0;
+}
+
+DLTMessageEncoder::~DLTMessageEncoder()
+{
+    delete[] buffer;
+}
+
+void DLTMessageEncoder::begin(const QString &appId, const QString &ctxId, int logLevel)
+{
+    length = 0;
+    arguments = 0;
+
+    // Standard Header (4 Byte), length is set in end()
+    buffer[length++] = 0x21; // htyp: Use extended header, version 0x1
+    buffer[length++] = (char)counter++; // message counter
+    buffer[length++] = 0x00; // length high byte
+    buffer[length++] = 0x00; // length low byte
+
+    // Extended Header (10 Byte)
+    buffer[length++] = (char)(0x01|(logLevel<<4)); // MSIN: Verbose,DLT_TYPE_LOG
+    buffer[length++] = 0x00; // NOAR, set in end()
+    addId(appId); // APID
+    addId(ctxId); // CTID
+}
+
+void DLTMessageEncoder::end()
+{
+    // length is always big endian
+    buffer[2] = (char)(length>>8);
+    buffer[3] = (char)length;
+
+    buffer[5] = (char)arguments;
+}
+
+void DLTMessageEncoder::addId(const QString &id)
+{
+    // ids are padded with zeros to four characters
+    for(int num=0;num<4;num++)
+        buffer[length++] = num<id.size() ? id[num].toLatin1() : 0x00;
+}
+
+void DLTMessageEncoder::addTypeInfo(unsigned int typeInfo)
+{
+    // Payload Type Info (4 Byte), little endian
+    buffer[length++] = (char)typeInfo;
+    buffer[length++] = (char)(typeInfo>>8);
+    buffer[length++] = (char)(typeInfo>>16);
+    buffer[length++] = (char)(typeInfo>>24);
+    arguments++;
+}
+
+void DLTMessageEncoder::addBytes(const void *data, int size)
+{
+    // platform is little endian like the type info
+    memcpy(buffer+length,data,size);
+    length += size;
+}
+
+void DLTMessageEncoder::add(const QString &text)
+{
+    // Payload Type Info, Data Length (2 Byte), Data and terminating zero
+    int available = maxLength-length-4-2-1;
+    if(available<0 || arguments>=255)
+        return;
+
+    addTypeInfo(DLT_TYPE_INFO_STRG_UTF8);
+    int lengthPos = length;
+    length += 2;
+
+    // convert UTF-16 to UTF-8 directly into the buffer, the text is truncated at the maximum message length
+    int start = length;
+    const QChar *chars = text.constData();
+    int size = text.size();
+    for(int num=0;num<size;num++)
+    {
+        unsigned int code = chars[num].unicode();
+        if(chars[num].isHighSurrogate() && num+1<size && chars[num+1].isLowSurrogate())
+        {
+            code = QChar::surrogateToUcs4(chars[num],chars[num+1]);
+            num++;
+        }
+
+        int bytes = code<0x80 ? 1 : code<0x800 ? 2 : code<0x10000 ? 3 : 4;
+        if(length-start+bytes>available)
+            break;
+
+        if(bytes==1)
+        {
+            buffer[length++] = (char)code;
+        }
+        else if(bytes==2)
+        {
+            buffer[length++] = (char)(0xc0|(code>>6));
+            buffer[length++] = (char)(0x80|(code&0x3f));
+        }
+        else if(bytes==3)
+        {
+            buffer[length++] = (char)(0xe0|(code>>12));
+            buffer[length++] = (char)(0x80|((code>>6)&0x3f));
+            buffer[length++] = (char)(0x80|(code&0x3f));
+        }
+        else
+        {
+            buffer[length++] = (char)(0xf0|(code>>18));
+            buffer[length++] = (char)(0x80|((code>>12)&0x3f));
+            buffer[length++] = (char)(0x80|((code>>6)&0x3f));
+            buffer[length++] = (char)(0x80|(code&0x3f));
+        }
+    }
+    buffer[length++] = 0x00;
+
+    setStringLength(lengthPos,length-start);
+}
+
+void DLTMessageEncoder::add(const char *text)
+{
+    // text is already UTF-8 and copied without conversion
+    int available = maxLength-length-4-2-1;
+    if(available<0 || arguments>=255)
+        return;
+
+    int size = (int)strlen(text);
+    if(size>available)
+        size = available;
+
+    addTypeInfo(DLT_TYPE_INFO_STRG_UTF8);
+    int lengthPos = length;
+    length += 2;
+    addBytes(text,size);
+    buffer[length++] = 0x00;
+
+    setStringLength(lengthPos,size+1);
+}
+
+void DLTMessageEncoder::setStringLength(int pos, int dataLength)
+{
+    // Payload Type Data Length in bytes including terminating zero, little endian
+    buffer[pos] = (char)dataLength;
+    buffer[pos+1] = (char)(dataLength>>8);
+}
+
+void DLTMessageEncoder::add(bool value)
+{
+    if(length+4+1>maxLength || arguments>=255)
+        return;
+
+    addTypeInfo(DLT_TYPE_INFO_BOOL);
+    buffer[length++] = value ? 0x01 : 0x00;
+}
+
+void DLTMessageEncoder::add(int value)
+{
+    if(length+4+4>maxLength || arguments>=255)
+        return;
+
+    qint32 data = value;
+    addTypeInfo(DLT_TYPE_INFO_SINT32);
+    addBytes(&data,4);
+}
+
+void DLTMessageEncoder::add(unsigned int value)
+{
+    if(length+4+4>maxLength || arguments>=255)
+        return;
+
+    quint32 data = value;
+    addTypeInfo(DLT_TYPE_INFO_UINT32);
+    addBytes(&data,4);
+}
+
+void DLTMessageEncoder::add(qint64 value)
+{
+    if(length+4+8>maxLength || arguments>=255)
+        return;
+
+    addTypeInfo(DLT_TYPE_INFO_SINT64);
+    addBytes(&value,8);
+}
+
+void DLTMessageEncoder::add(quint64 value)
+{
+    if(length+4+8>maxLength || arguments>=255)
+        return;
+
+    addTypeInfo(DLT_TYPE_INFO_UINT64);
+    addBytes(&value,8);
+}
+
+void DLTMessageEncoder::add(float value)
+{
+    if(length+4+4>maxLength || arguments>=255)
+        return;
+
+    addTypeInfo(DLT_TYPE_INFO_FLOAT32);
+    addBytes(&value,4);
+}
+
+void DLTMessageEncoder::add(double value)
+{
+    if(length+4+8>maxLength || arguments>=255)
+        return;
+
+    addTypeInfo(DLT_TYPE_INFO_FLOAT64);
+    addBytes(&value,8);
+}
+
+QString DLTMessageEncoder::benchmark(int count)
+{
+    DLTMessageEncoder encoder;
+    QString appId("DLT");
+    QString ctxId("Mini");
+    QString step("test step");
+    QString commandNum("3");
+    QString command("find equal ECU1 APP1 CON1 Temperature 42");
+
+    QElapsedTimer timer;
+
+    // test steps like sent during a run, three strings
+    qint64 bytes = 0;
+    timer.start();
+    for(int num=0;num<count;num++)
+    {
+        encoder.encode(appId,ctxId,4,step,commandNum,command);
+        bytes += encoder.size();
+    }
+    qint64 stringsTime = timer.nsecsElapsed();
+
+    // mixed arguments
+    timer.restart();
+    for(int num=0;num<count;num++)
+    {
+        encoder.encode(appId,ctxId,4,"value",num,3.5,true);
+        bytes += encoder.size();
+    }
+    qint64 mixedTime = timer.nsecsElapsed();
+
+    return QString("encoded %1 messages (%2 bytes)\n3 strings: %3 messages/s\nstring, int, double, bool: %4 messages/s")
+            .arg(2*(qint64)count).arg(bytes)
+            .arg(count/(qMax(stringsTime,(qint64)1)/1000000000.0),0,'f',0)
+            .arg(count/(qMax(mixedTime,(qint64)1)/1000000000.0),0,'f',0);
+}
@@ -0,0 +1,86 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltmessageencoder.h
+ * @licence end@
+ */
+#ifndef DLTMESSAGEENCODER_H
+#define DLTMESSAGEENCODER_H
+
+#include <QString>
+
+// Encodes verbose DLT log messages into a buffer allocated once.
+// Any number of string, integer, floating point and bool arguments can be encoded:
+//   encoder.encode("DLT","Mini",DLT_LOG_INFO,"value",42,3.5,true);
+//   tcpSocket->write(encoder.data(),encoder.size());
+// Strings are encoded as UTF-8 with terminating zero, arguments not fitting
+// into the maximum message length of 65535 bytes are truncated or skipped.
+class DLTMessageEncoder
+{
+public:
+    DLTMessageEncoder();
+    ~DLTMessageEncoder();
+
+    template<typename... Args>
+    void encode(const QString &appId, const QString &ctxId, int logLevel, const Args&... args)
+    {
+        begin(appId,ctxId,logLevel);
+        addArguments(args...);
+        end();
+    }
+
+    void begin(const QString &appId, const QString &ctxId, int logLevel);
+    void end();
+
+    void add(const QString &text);
+    void add(const char *text);
+    void add(bool value);
+    void add(int value);
+    void add(unsigned int value);
+    void add(qint64 value);
+    void add(quint64 value);
+    void add(float value);
+    void add(double value);
+
+    // encoded message, valid until the next message is encoded
+    const char *data() const { return buffer; }
+    int size() const { return length; }
+
+    enum { maxLength = 65535 };
+
+    // encodes count typical test robot messages and returns the measured rate
+    static QString benchmark(int count);
+
+private:
+
+    void addArguments() {}
+
+    template<typename T, typename... Args>
+    void addArguments(const T &first, const Args&... rest)
+    {
+        add(first);
+        addArguments(rest...);
+    }
+
+    void addTypeInfo(unsigned int typeInfo);
+    void setStringLength(int pos, int dataLength);
+    void addBytes(const void *data, int size);
+    void addId(const QString &id);
+
+    DLTMessageEncoder(const DLTMessageEncoder &);
+    DLTMessageEncoder &operator=(const DLTMessageEncoder &);
+
+    char *buffer;
+    int length;
+    int arguments;
+    unsigned char counter;
+};
+
+#endif // DLTMESSAGEENCODER_H
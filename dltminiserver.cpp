@@ -16,13 +16,34 @@
 
 #include <QDebug>
 #include <QFile>
+#include <QDateTime>
+
+// bytes written to the socket of a client, further messages are kept in the send queue of the client
+static const qint64 socketWatermark = 64*1024;
+
+// collected messages are sent at once, when this size is reached
+static const int flushSize = 16*1024;
 
 DLTMiniServer::DLTMiniServer(QObject *parent) : QObject(parent)
 {
     clearSettings();
 
-    tcpSocket = 0;
-
+    outputBuffer.reserve(flushSize+DLTMessageEncoder::maxLength);
+    flushTimer.setSingleShot(true);
+    connect(&flushTimer, SIGNAL(timeout()), this, SLOT(flushExpired()));
+    stepTimer.setSingleShot(true);
+    connect(&stepTimer, SIGNAL(timeout()), this, SLOT(stepExpired()));
+
+    stepClock.start();
+    stepSecond = 0;
+    stepCount = 0;
+    stepsSuppressed = 0;
+
+    statFrames = 0;
+    statInjections = 0;
+    statBytes = 0;
+    statResyncs = 0;
+    statDiscardedBytes = 0;
 }
 
 DLTMiniServer::~DLTMiniServer()
@@ -35,7 +56,6 @@ void DLTMiniServer::start()
     if(tcpServer.isListening())
         return;
 
-    tcpServer.setMaxPendingConnections(1);
     if(tcpServer.listen(QHostAddress::Any,port)==true)
     {
         connect(&tcpServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
@@ -53,18 +73,15 @@ void DLTMiniServer::start()
 
 void DLTMiniServer::stop()
 {
-    if(tcpSocket && tcpSocket->isOpen())
-    {
-        disconnect(tcpSocket, SIGNAL(connected()), this, SLOT(connected()));
-        disconnect(tcpSocket, SIGNAL(disconnected()), this, SLOT(disconnected()));
-        tcpSocket->close();
-    }
+    flush();
+    closeFile();
+
+    while(!clients.isEmpty())
+        removeClient(clients.first());
 
     disconnect(&tcpServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
     tcpServer.close();
 
-    readData.clear();
-
     status("stopped");
     qDebug() << "DLTMiniServer: stopped" << port;
 }
@@ -74,6 +91,14 @@ void DLTMiniServer::clearSettings()
     port = 3491;
     applicationId = "DLT";
     contextId = "Mini";
+    ecuId = "TEST";
+    maxClients = 4;
+    clientQueueSize = 1024;
+    slowClientPolicy = DropOldest;
+    flushDelay = 10;
+    logLevel = DLT_LOG_VERBOSE;
+    stepLogLevel = DLT_LOG_INFO;
+    maxStepRate = 0;
 }
 
 void DLTMiniServer::writeSettings(QXmlStreamWriter &xml)
@@ -83,6 +108,14 @@ void DLTMiniServer::writeSettings(QXmlStreamWriter &xml)
         xml.writeTextElement("port",QString("%1").arg(port));
         xml.writeTextElement("applicationId",applicationId);
         xml.writeTextElement("contextId",contextId);
+        xml.writeTextElement("ecuId",ecuId);
+        xml.writeTextElement("maxClients",QString("%1").arg(maxClients));
+        xml.writeTextElement("clientQueueSize",QString("%1").arg(clientQueueSize));
+        xml.writeTextElement("slowClientPolicy",QString("%1").arg(slowClientPolicy));
+        xml.writeTextElement("flushDelay",QString("%1").arg(flushDelay));
+        xml.writeTextElement("logLevel",QString("%1").arg(logLevel));
+        xml.writeTextElement("stepLogLevel",QString("%1").arg(stepLogLevel));
+        xml.writeTextElement("maxStepRate",QString("%1").arg(maxStepRate));
     xml.writeEndElement(); // DLTMiniServer
 }
 
@@ -117,6 +150,38 @@ void DLTMiniServer::readSettings(const QString &filename)
                   {
                       contextId = xml.readElementText();
                   }
+                  if(xml.name() == QString("ecuId"))
+                  {
+                      ecuId = xml.readElementText();
+                  }
+                  if(xml.name() == QString("maxClients"))
+                  {
+                      maxClients = qMax(1,xml.readElementText().toInt());
+                  }
+                  if(xml.name() == QString("clientQueueSize"))
+                  {
+                      clientQueueSize = qMax(1,xml.readElementText().toInt());
+                  }
+                  if(xml.name() == QString("slowClientPolicy"))
+                  {
+                      slowClientPolicy = (SlowClientPolicy)xml.readElementText().toInt();
+                  }
+                  if(xml.name() == QString("flushDelay"))
+                  {
+                      flushDelay = xml.readElementText().toInt();
+                  }
+                  if(xml.name() == QString("logLevel"))
+                  {
+                      logLevel = xml.readElementText().toInt();
+                  }
+                  if(xml.name() == QString("stepLogLevel"))
+                  {
+                      stepLogLevel = xml.readElementText().toInt();
+                  }
+                  if(xml.name() == QString("maxStepRate"))
+                  {
+                      maxStepRate = xml.readElementText().toInt();
+                  }
               }
               else if(xml.name() == QString("DLTMiniServer"))
               {
@@ -144,283 +209,425 @@ void DLTMiniServer::readSettings(const QString &filename)
 
 void DLTMiniServer::readyRead()
 {
-    while(tcpSocket && tcpSocket->bytesAvailable())
+    DLTMiniServerClient *client = this->client(sender());
+    if(!client)
+        return;
+
+    QTcpSocket *tcpSocket = client->tcpSocket;
+    QByteArray &readData = client->readData;
+
+    while(tcpSocket->bytesAvailable())
     {
-        readData += tcpSocket->readAll();
+        QByteArray data = tcpSocket->readAll();
+        statBytes += data.size();
+        readData += data;
 
-        // check if complete DLT message is received
-        do
+        // parse all complete DLT messages in place, the consumed bytes are removed once afterwards
+        int offset = 0;
+        while(readData.size()-offset>=4)
         {
-            if(readData.size()>=4)
+            const unsigned char *frame = (const unsigned char*)readData.constData()+offset;
+            int available = readData.size()-offset;
+
+            int length = parseFrame(frame,available);
+            if(length<0)
             {
-                // calculate size
-                unsigned short length = (unsigned short)(readData[3]) | ((unsigned short)(readData[2]) << 8);
-                if(readData.size()>=length)
+                // corrupted message, skip one byte and search the next valid header
+                offset++;
+                statDiscardedBytes++;
+                if(!client->resyncing)
                 {
-                    //qDebug() << "DLTMiniServer: msg received with length" << length;
+                    client->resyncing = true;
+                    statResyncs++;
+                    qDebug() << "DLTMiniServer: invalid message header, resync";
+                }
+                continue;
+            }
+            if(length==0)
+                break; // no full message received
 
-                    unsigned char htyp = (unsigned char)(readData[0]);
+            client->resyncing = false;
+            statFrames++;
+            offset += length;
+        }
 
-                    unsigned short standardHeaderLength = 4;
-                    if(htyp&0x04) standardHeaderLength+=4; // with ecu id
-                    if(htyp&0x08) standardHeaderLength+=4; // with session id
-                    if(htyp&0x10) standardHeaderLength+=4; // with timestamp
+        if(offset>0)
+            readData.remove(0,offset);
 
-                    //qDebug() << "DLTMiniServer: header length" << standardHeaderLength;
+        // injections are emitted after parsing, the receivers may close the connection
+        QStringList injections = receivedInjections;
+        receivedInjections.clear();
+        for(int num=0;num<injections.size();num++)
+            injection(injections[num]);
 
-                    if(htyp&0x01) // use of extended header
-                    {
-                        unsigned char msin = (unsigned char)(readData[standardHeaderLength]);
-                        unsigned char mstp = (msin >> 1) & 0x07;
-                        unsigned char mtin = (msin >> 4) & 0x0f;
+        if(!clients.contains(client))
+            return;
+    }
+}
+
+int DLTMiniServer::parseFrame(const unsigned char *frame, int available)
+{
+    // Standard Header
+    unsigned char htyp = frame[0];
+    if(((htyp>>5)&0x07)!=1)
+        return -1; // only version 1 is supported
 
-                        //qDebug() << "DLTMiniServer: mstp" << mstp << "mtin" << mtin;
+    bool msbf = htyp&0x02;
 
-                        if(mstp==0x3 && mtin == 0x01 && readData.size()>=standardHeaderLength+10+4) // Control request message
-                        {
-                            unsigned int serviceId = (unsigned int)(readData[standardHeaderLength+10]) |
-                                                     (unsigned int)(readData[standardHeaderLength+11]) << 8 |
-                                                    (unsigned int)(readData[standardHeaderLength+12]) << 16 |
-                                                    (unsigned int)(readData[standardHeaderLength+13]) << 24;
+    int standardHeaderLength = 4;
+    if(htyp&0x04) standardHeaderLength+=4; // with ecu id
+    if(htyp&0x08) standardHeaderLength+=4; // with session id
+    if(htyp&0x10) standardHeaderLength+=4; // with timestamp
 
-                            //qDebug() << "DLTMiniServer: serviceId" << serviceId;
+    int headerLength = standardHeaderLength;
+    if(htyp&0x01) headerLength+=10; // use of extended header
 
-                            if(serviceId==4096 && readData.size()>=standardHeaderLength+10+4+4)
-                            {
-                                unsigned int lengthData = (unsigned int)(readData[standardHeaderLength+14]) |
-                                                            (unsigned int)(readData[standardHeaderLength+15]) << 8 |
-                                                            (unsigned int)(readData[standardHeaderLength+15]) << 16 |
-                                                            (unsigned int)(readData[standardHeaderLength+15]) << 24;
+    // length of the message is always big endian
+    int length = (int)frame[3] | ((int)frame[2] << 8);
+    if(length<headerLength)
+        return -1;
 
-                                //qDebug() << "DLTMiniServer: lengthData" << lengthData;
+    if(available<length)
+        return 0;
+
+    if(htyp&0x01) // use of extended header
+    {
+        unsigned char msin = frame[standardHeaderLength];
+        unsigned char mstp = (msin >> 1) & 0x07;
+        unsigned char mtin = (msin >> 4) & 0x0f;
+
+        if(mstp==0x3 && mtin == 0x01 && length>=headerLength+4) // Control request message
+        {
+            unsigned int serviceId = readUInt32(frame+headerLength,msbf);
 
-                                if(readData.size()>=standardHeaderLength+18+lengthData)
-                                {
-                                    QByteArray injectionData = readData.mid(standardHeaderLength+18,lengthData);
-                                    QString injectionStr = QString::fromLatin1(injectionData);
+            if(serviceId==4096 && length>=headerLength+8)
+            {
+                unsigned int lengthData = readUInt32(frame+headerLength+4,msbf);
 
-                                    //qDebug() << "DLTMiniServer: injection" << injectionStr;
+                if(lengthData<=(unsigned int)(length-headerLength-8))
+                {
+                    QString injectionStr = QString::fromLatin1((const char*)frame+headerLength+8,lengthData);
 
-                                    injection(injectionStr);
-                                }
-                            }
+                    //qDebug() << "DLTMiniServer: injection" << injectionStr;
 
-                        }
-                    }
-                    readData.remove(0,length); // full message received, delete
+                    statInjections++;
+                    receivedInjections.append(injectionStr);
                 }
                 else
                 {
-                    break; // no full message received
+                    qDebug() << "DLTMiniServer: injection length exceeds message" << lengthData;
                 }
             }
-            else
-            {
-                break; // no full message received
-            }
-        } while(true);
+        }
     }
+
+    return length;
+}
+
+unsigned int DLTMiniServer::readUInt32(const unsigned char *data, bool msbf)
+{
+    if(msbf)
+        return (unsigned int)data[3] | (unsigned int)data[2] << 8 | (unsigned int)data[1] << 16 | (unsigned int)data[0] << 24;
+    else
+        return (unsigned int)data[0] | (unsigned int)data[1] << 8 | (unsigned int)data[2] << 16 | (unsigned int)data[3] << 24;
+}
+
+QString DLTMiniServer::getStatistics() const
+{
+    return QString("messages %1 injections %2 bytes %3 resyncs %4 discarded bytes %5")
+            .arg(statFrames).arg(statInjections).arg(statBytes).arg(statResyncs).arg(statDiscardedBytes);
 }
 
 void DLTMiniServer::newConnection()
 {
-    tcpSocket = tcpServer.nextPendingConnection();
-    connect(tcpSocket, SIGNAL(connected()), this, SLOT(connected()));
-    connect(tcpSocket, SIGNAL(disconnected()), this, SLOT(disconnected()));
-    connect(tcpSocket, SIGNAL(readyRead()), this, SLOT(readyRead()));
-    tcpServer.pauseAccepting();
+    int accepted = 0;
+    while(tcpServer.hasPendingConnections() && clients.size()<maxClients)
+    {
+        DLTMiniServerClient *client = new DLTMiniServerClient();
+        client->tcpSocket = tcpServer.nextPendingConnection();
+        connect(client->tcpSocket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+        connect(client->tcpSocket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+        connect(client->tcpSocket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten(qint64)));
+        clients.append(client);
+        accepted++;
+
+        qDebug() << "DLTMiniServer: client connected" << client->tcpSocket->peerAddress().toString() << "clients" << clients.size();
+    }
 
-    readData.clear();
+    // further clients are accepted when a client disconnects
+    if(clients.size()>=maxClients)
+        tcpServer.pauseAccepting();
 
-    status("connected");
+    if(accepted>0)
+        status("connected");
 }
 
-void DLTMiniServer::connected()
+void DLTMiniServer::disconnected()
 {
+    DLTMiniServerClient *client = this->client(sender());
+    if(!client)
+        return;
+
+    removeClient(client);
+
+    qDebug() << "DLTMiniServer: client disconnected, clients" << clients.size() << getStatistics();
 
+    if(tcpServer.isListening())
+    {
+        tcpServer.resumeAccepting();
+
+        if(clients.isEmpty())
+            status("listening");
+
+        // accept the connections waiting while all clients were connected
+        newConnection();
+    }
 }
 
-void DLTMiniServer::disconnected()
+DLTMiniServerClient *DLTMiniServer::client(QObject *socket)
 {
-    tcpSocket->close();
-    disconnect(tcpSocket, SIGNAL(connected()), this, SLOT(connected()));
-    disconnect(tcpSocket, SIGNAL(disconnected()), this, SLOT(disconnected()));
-    disconnect(tcpSocket, SIGNAL(readyRead()), this, SLOT(readyRead()));
-    //delete tcpSocket;
-    tcpSocket = 0;
-    tcpServer.resumeAccepting();
+    for(int num=0;num<clients.size();num++)
+    {
+        if(clients[num]->tcpSocket==socket)
+            return clients[num];
+    }
+    return 0;
+}
 
-    readData.clear();
+void DLTMiniServer::removeClient(DLTMiniServerClient *client)
+{
+    clients.removeAll(client);
 
-    status("listening");
+    disconnect(client->tcpSocket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+    disconnect(client->tcpSocket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    disconnect(client->tcpSocket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten(qint64)));
+    client->tcpSocket->close();
+    client->tcpSocket->deleteLater();
+
+    if(client->dropped>0)
+        qDebug() << "DLTMiniServer: messages dropped for slow client" << client->dropped;
+
+    delete client;
+}
+
+void DLTMiniServer::broadcast(const char *data, int size)
+{
+    QList<DLTMiniServerClient*> slowClients;
+
+    for(int num=0;num<clients.size();num++)
+    {
+        DLTMiniServerClient *client = clients[num];
+
+        // write directly while the client reads fast enough
+        if(client->queue.isEmpty() && client->tcpSocket->bytesToWrite()<socketWatermark)
+        {
+            client->tcpSocket->write(data,size);
+            continue;
+        }
+
+        client->queue.append(QByteArray(data,size));
+        client->queueBytes += size;
+
+        // send queue full
+        while(client->queueBytes>(qint64)clientQueueSize*1024 && !client->queue.isEmpty())
+        {
+            if(slowClientPolicy==Disconnect)
+            {
+                slowClients.append(client);
+                break;
+            }
+            client->queueBytes -= client->queue.first().size();
+            client->queue.removeFirst();
+            client->dropped++;
+        }
+    }
+
+    for(int num=0;num<slowClients.size();num++)
+    {
+        qDebug() << "DLTMiniServer: disconnect slow client" << slowClients[num]->tcpSocket->peerAddress().toString();
+        slowClients[num]->tcpSocket->abort();
+    }
+}
+
+void DLTMiniServer::bytesWritten(qint64 bytes)
+{
+    Q_UNUSED(bytes);
+
+    DLTMiniServerClient *client = this->client(sender());
+    if(client)
+        writeQueue(client);
+}
+
+void DLTMiniServer::writeQueue(DLTMiniServerClient *client)
+{
+    while(!client->queue.isEmpty() && client->tcpSocket->bytesToWrite()<socketWatermark)
+    {
+        QByteArray data = client->queue.takeFirst();
+        client->queueBytes -= data.size();
+        client->tcpSocket->write(data);
+    }
 }
 
 void DLTMiniServer::sendValue(QString appId,QString ctxId, QString text,int logLevel)
 {
-    if(tcpSocket==0 || !tcpSocket->isOpen())
+    if(!isActive() || logLevel>this->logLevel)
     {
         return;
     }
 
-    QByteArray data;
-
-    // Standard Header (4 Byte)
-    data += 0x21; // htyp: Use extended header, version 0x1
-    data += (char)0x00; // message counter
-    data += (char)0x00; // length high byte
-    data += (char)4+10+4+2+text.length(); // length low byte
-
-    // Extended Header (10 Byte)
-    data += (char)0x01|(char)logLevel<<4; // MSIN: Verbose,DLT_TYPE_LOG
-    data += (char)0x01; // NOAR
-    data += appId[0].toLatin1(); // APID
-    data += appId[1].toLatin1(); // APID
-    data += appId[2].toLatin1(); // APID
-    data += appId[3].toLatin1(); // APID
-    data += ctxId[0].toLatin1(); // CTID
-    data += ctxId[1].toLatin1(); // CTID
-    data += ctxId[2].toLatin1(); // CTID
-    data += ctxId[3].toLatin1(); // CTID
-
-    // Payload Type Info (4 Byte)
-    data += (char)0x00;
-    data += (char)0x02; // String
-    data += (char)0x00;
-    data += (char)0x00;
-
-    // Payload Type Data Length
-    data += ((char)text.length()); // length low byte
-    data += ((char)0x00); // length high byte
-
-    // Payload Type Data
-    data += text.toUtf8();
-
-    tcpSocket->write(data);
+    encoder.encode(appId,ctxId,logLevel,text);
+    output(logLevel);
 }
 
 void DLTMiniServer::sendValue2(QString appId,QString ctxId, QString text1,QString text2,int logLevel)
 {
-    if(tcpSocket==0 || !tcpSocket->isOpen())
+    if(!isActive() || logLevel>this->logLevel)
     {
         return;
     }
 
-    QByteArray data;
-
-    // Standard Header (4 Byte)
-    data += 0x21; // htyp: Use extended header, version 0x1
-    data += (char)0x00; // message counter
-    data += (char)0x00; // length high byte
-    data += (char)4+10+4+2+text1.length()+4+2+text2.length(); // length low byte
-
-    // Extended Header (10 Byte)
-    data += (char)0x01|(char)logLevel<<4; // MSIN: Verbose,DLT_TYPE_LOG
-    data += (char)0x02; // NOAR
-    data += appId[0].toLatin1(); // APID
-    data += appId[1].toLatin1(); // APID
-    data += appId[2].toLatin1(); // APID
-    data += appId[3].toLatin1(); // APID
-    data += ctxId[0].toLatin1(); // CTID
-    data += ctxId[1].toLatin1(); // CTID
-    data += ctxId[2].toLatin1(); // CTID
-    data += ctxId[3].toLatin1(); // CTID
-
-    // Payload Type Info (4 Byte)
-    data += (char)0x00;
-    data += (char)0x02; // String
-    data += (char)0x00;
-    data += (char)0x00;
-
-    // Payload Type Data Length
-    data += ((char)text1.length()); // length low byte
-    data += ((char)0x00); // length high byte
-
-    // Payload Type Data
-    data += text1.toUtf8();
-
-    // Payload Type Info (4 Byte)
-    data += (char)0x00;
-    data += (char)0x02; // String
-    data += (char)0x00;
-    data += (char)0x00;
-
-    // Payload Type Data Length
-    data += ((char)text2.length()); // length low byte
-    data += ((char)0x00); // length high byte
-
-    // Payload Type Data
-    data += text2.toUtf8();
-
-    tcpSocket->write(data);
-
+    encoder.encode(appId,ctxId,logLevel,text1,text2);
+    output(logLevel);
 }
 
 void DLTMiniServer::sendValue3(QString appId,QString ctxId, QString text1,QString text2,QString text3,int logLevel)
 {
-    if(tcpSocket==0 || !tcpSocket->isOpen())
+    if(!isActive() || logLevel>this->logLevel)
     {
         return;
     }
 
-    QByteArray data;
-
-    // Standard Header (4 Byte)
-    data += 0x21; // htyp: Use extended header, version 0x1
-    data += (char)0x00; // message counter
-    data += (char)0x00; // length high byte
-    data += (char)4+10+4+2+text1.length()+4+2+text2.length()+4+2+text3.length(); // length low byte
-
-    // Extended Header (10 Byte)
-    data += (char)0x01|(char)logLevel<<4; // MSIN: Verbose,DLT_TYPE_LOG
-    data += (char)0x03; // NOAR
-    data += appId[0].toLatin1(); // APID
-    data += appId[1].toLatin1(); // APID
-    data += appId[2].toLatin1(); // APID
-    data += appId[3].toLatin1(); // APID
-    data += ctxId[0].toLatin1(); // CTID
-    data += ctxId[1].toLatin1(); // CTID
-    data += ctxId[2].toLatin1(); // CTID
-    data += ctxId[3].toLatin1(); // CTID
-
-    // Payload Type Info (4 Byte)
-    data += (char)0x00;
-    data += (char)0x02; // String
-    data += (char)0x00;
-    data += (char)0x00;
-
-    // Payload Type Data Length
-    data += ((char)text1.length()); // length low byte
-    data += ((char)0x00); // length high byte
-
-    // Payload Type Data
-    data += text1.toUtf8();
-
-    // Payload Type Info (4 Byte)
-    data += (char)0x00;
-    data += (char)0x02; // String
-    data += (char)0x00;
-    data += (char)0x00;
-
-    // Payload Type Data Length
-    data += ((char)text2.length()); // length low byte
-    data += ((char)0x00); // length high byte
-
-    // Payload Type Data
-    data += text2.toUtf8();
-
-    // Payload Type Info (4 Byte)
-    data += (char)0x00;
-    data += (char)0x02; // String
-    data += (char)0x00;
-    data += (char)0x00;
-
-    // Payload Type Data Length
-    data += ((char)text3.length()); // length low byte
-    data += ((char)0x00); // length high byte
-
-    // Payload Type Data
-    data += text3.toUtf8();
-
-    tcpSocket->write(data);
+    encoder.encode(appId,ctxId,logLevel,text1,text2,text3);
+    output(logLevel);
+}
+
+void DLTMiniServer::sendStep(QString commandNum,QString text)
+{
+    if(!isActive() || stepLogLevel>logLevel)
+    {
+        return;
+    }
+
+    if(maxStepRate>0)
+    {
+        // count the steps in each second, steps above the rate are only counted
+        qint64 second = stepClock.elapsed()/1000;
+        if(second!=stepSecond)
+        {
+            sendSuppressedSteps();
+            stepSecond = second;
+            stepCount = 0;
+        }
+        if(stepCount>=maxStepRate)
+        {
+            // the number of suppressed steps is sent at the end of the second
+            if(stepsSuppressed==0)
+                stepTimer.start(1000-stepClock.elapsed()%1000);
+            stepsSuppressed++;
+            return;
+        }
+        stepCount++;
+    }
+
+    sendValue3("test step",commandNum,text,stepLogLevel);
+}
+
+void DLTMiniServer::sendSuppressedSteps()
+{
+    stepTimer.stop();
+
+    if(stepsSuppressed==0)
+        return;
+
+    int count = stepsSuppressed;
+    stepsSuppressed = 0;
+    sendValue2("test steps suppressed",QString("%1").arg(count),stepLogLevel);
+}
 
+void DLTMiniServer::stepExpired()
+{
+    sendSuppressedSteps();
+}
+
+void DLTMiniServer::output(int logLevel)
+{
+    if(!clients.isEmpty())
+        outputBuffer.append(encoder.data(),encoder.size());
+
+    if(dltFile.isOpen())
+    {
+        // Storage Header (16 Byte): pattern, time in seconds and microseconds, ECU id
+        qint64 time = QDateTime::currentMSecsSinceEpoch();
+        quint32 seconds = (quint32)(time/1000);
+        qint32 microseconds = (qint32)(time%1000)*1000;
+        char header[16] = {'D','L','T',0x01};
+        for(int num=0;num<4;num++)
+        {
+            header[4+num] = (char)(seconds>>(8*num));
+            header[8+num] = (char)(microseconds>>(8*num));
+            header[12+num] = num<ecuId.size() ? ecuId[num].toLatin1() : 0x00;
+        }
+        fileBuffer.append(header,16);
+        fileBuffer.append(encoder.data(),encoder.size());
+    }
+
+    // errors are sent immediately, other messages are collected
+    if(logLevel<=DLT_LOG_ERROR || outputBuffer.size()>=flushSize || fileBuffer.size()>=flushSize)
+        writeOutput();
+    else if(!flushTimer.isActive())
+        flushTimer.start(flushDelay);
+}
+
+void DLTMiniServer::flush()
+{
+    // the suppressed steps are sent before all collected messages
+    sendSuppressedSteps();
+    writeOutput();
+}
+
+void DLTMiniServer::writeOutput()
+{
+    flushTimer.stop();
+
+    if(!fileBuffer.isEmpty())
+    {
+        dltFile.write(fileBuffer);
+        fileBuffer.clear();
+    }
+
+    if(outputBuffer.isEmpty())
+        return;
+
+    broadcast(outputBuffer.constData(),outputBuffer.size());
+
+    // keeps the reserved capacity
+    outputBuffer.resize(0);
+}
+
+bool DLTMiniServer::openFile(const QString &filename)
+{
+    closeFile();
+
+    if(!dltFile.open(filename,false))
+    {
+        qDebug() << "DLTMiniServer: cannot open DLT file" << filename;
+        return false;
+    }
+
+    qDebug() << "DLTMiniServer: DLT file" << filename;
+    return true;
+}
+
+void DLTMiniServer::closeFile()
+{
+    if(!dltFile.isOpen())
+        return;
+
+    flush();
+    dltFile.close();
+}
+
+void DLTMiniServer::flushExpired()
+{
+    writeOutput();
 }
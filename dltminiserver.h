@@ -20,6 +20,13 @@
 #include <QXmlStreamReader>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QStringList>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "dltmessageencoder.h"
+#include "dltreportwriter.h"
 
 #define DLT_LOG_FATAL 0x1
 #define DLT_LOG_ERROR 0x2
@@ -28,6 +35,22 @@
 #define DLT_LOG_DEBUG 0x5
 #define DLT_LOG_VERBOSE 0x6
 
+// Client connected to the DLT Mini Server, messages are queued while the client is slow
+class DLTMiniServerClient
+{
+public:
+    DLTMiniServerClient() : tcpSocket(0), resyncing(false), queueBytes(0), dropped(0) {}
+
+    QTcpSocket *tcpSocket;
+
+    QByteArray readData;
+    bool resyncing;
+
+    QList<QByteArray> queue;
+    qint64 queueBytes;
+    quint64 dropped;
+};
+
 class DLTMiniServer : public QObject
 {
     Q_OBJECT
@@ -45,8 +68,31 @@ public:
     void sendValue2(QString appId,QString ctxId, QString text1,QString text2,int logLevel = DLT_LOG_INFO);
     void sendValue3(QString appId,QString ctxId, QString text1,QString text2,QString text3,int logLevel = DLT_LOG_INFO);
 
+    // send a message with any number of string, integer, floating point and bool arguments
+    template<typename... Args>
+    void sendValues(int logLevel, const Args&... args)
+    {
+        if(!isActive() || logLevel>this->logLevel)
+            return;
+
+        encoder.encode(applicationId,contextId,logLevel,args...);
+        output(logLevel);
+    }
+
+    // send a test step with the step log level, limited to maxStepRate steps per second
+    void sendStep(QString commandNum,QString text);
+
+    // send the number of suppressed test steps and all collected messages to the clients and the DLT file
+    void flush();
+
+    // write all sent messages with storage header to a DLT file, also when no client is connected
+    bool openFile(const QString &filename);
+    void closeFile();
+    bool isFileOpen() const { return dltFile.isOpen(); }
+
     unsigned short getPort() { return port; }
     void setPort(unsigned short port) { this->port = port; }
+    bool isListening() const { return tcpServer.isListening(); }
 
     QString getApplicationId() { return applicationId; }
     void setApplicationId(QString id) { this->applicationId = id; }
@@ -54,10 +100,51 @@ public:
     QString getContextId() { return contextId; }
     void setContextId(QString id) { this->contextId = id; }
 
+    // ECU id of the storage header in the DLT file
+    QString getEcuId() { return ecuId; }
+    void setEcuId(QString id) { this->ecuId = id; }
+
+    // maximum number of clients, further connections are accepted when a client disconnects
+    int getMaxClients() const { return maxClients; }
+    void setMaxClients(int value) { maxClients = qMax(1,value); }
+
+    // maximum size of the send queue of each client in KB
+    int getClientQueueSize() const { return clientQueueSize; }
+    void setClientQueueSize(int value) { clientQueueSize = qMax(1,value); }
+
+    // handling of clients not reading fast enough, when the send queue is full
+    enum SlowClientPolicy {DropOldest,Disconnect};
+    SlowClientPolicy getSlowClientPolicy() const { return slowClientPolicy; }
+    void setSlowClientPolicy(SlowClientPolicy value) { slowClientPolicy = value; }
+
+    int getClientCount() const { return clients.size(); }
+
+    // messages are collected and sent together after flushDelay ms, 0 sends them when the event loop is idle
+    int getFlushDelay() const { return flushDelay; }
+    void setFlushDelay(int value) { flushDelay = value; }
+
+    // messages with a higher log level are not sent
+    int getLogLevel() const { return logLevel; }
+    void setLogLevel(int value) { logLevel = value; }
+
+    int getStepLogLevel() const { return stepLogLevel; }
+    void setStepLogLevel(int value) { stepLogLevel = value; }
+
+    // maximum number of test steps sent per second, 0 sends all steps
+    int getMaxStepRate() const { return maxStepRate; }
+    void setMaxStepRate(int value) { maxStepRate = value; }
+
     void clearSettings();
     void writeSettings(QXmlStreamWriter &xml);
     void readSettings(const QString &filename);
 
+    // statistics of the messages received from the clients
+    quint64 getReceivedMessages() const { return statFrames; }
+    quint64 getReceivedInjections() const { return statInjections; }
+    quint64 getResyncs() const { return statResyncs; }
+    quint64 getDiscardedBytes() const { return statDiscardedBytes; }
+    QString getStatistics() const;
+
 signals:
 
     void status(QString text);
@@ -66,20 +153,67 @@ signals:
 private slots:
 
     void readyRead();
+    void bytesWritten(qint64 bytes);
+    void flushExpired();
+    void stepExpired();
     void newConnection();
-    void connected();
     void disconnected();
 
 private:
 
     QTcpServer tcpServer;
-    QTcpSocket *tcpSocket;
+    QList<DLTMiniServerClient*> clients;
 
     unsigned short port;
     QString applicationId;
     QString contextId;
-
-    QByteArray readData;
+    QString ecuId;
+
+    int maxClients;
+    int clientQueueSize;
+    SlowClientPolicy slowClientPolicy;
+
+    int flushDelay;
+    int logLevel;
+    int stepLogLevel;
+    int maxStepRate;
+
+    // messages encoded but not yet sent to the clients
+    QByteArray outputBuffer;
+    QTimer flushTimer;
+
+    // messages with storage header not yet written to the DLT file
+    DLTReportWriter dltFile;
+    QByteArray fileBuffer;
+
+    QElapsedTimer stepClock;
+    QTimer stepTimer;
+    qint64 stepSecond;
+    int stepCount;
+    int stepsSuppressed;
+
+    bool isActive() const { return !clients.isEmpty() || dltFile.isOpen(); }
+    void output(int logLevel);
+    void writeOutput();
+    void sendSuppressedSteps();
+    DLTMiniServerClient *client(QObject *socket);
+    void removeClient(DLTMiniServerClient *client);
+    void broadcast(const char *data, int size);
+    void writeQueue(DLTMiniServerClient *client);
+
+    // returns the length of the complete message, 0 when more data is needed and -1 when the header is invalid
+    int parseFrame(const unsigned char *frame, int available);
+    static unsigned int readUInt32(const unsigned char *data, bool msbf);
+
+    DLTMessageEncoder encoder;
+
+    QStringList receivedInjections;
+
+    quint64 statFrames;
+    quint64 statInjections;
+    quint64 statBytes;
+    quint64 statResyncs;
+    quint64 statDiscardedBytes;
 
 };
 
@@ -0,0 +1,116 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltperformancemonitor.cpp
+ * @licence end@
+ */
+#include "dltperformancemonitor.h"
+#include "dlttestrobot.h"
+#include "dlttestreport.h"
+
+#include <QStringList>
+
+static const int probeInterval = 50;
+
+DLTPerformanceMonitor::DLTPerformanceMonitor(DLTTestRobot *dltTestRobot, DLTTestReport *testReport, QObject *parent) : QObject(parent)
+{
+    this->dltTestRobot = dltTestRobot;
+    this->testReport = testReport;
+
+    sampleTime = 0;
+    receivedMessages = 0;
+    matchEvaluations = 0;
+    probeTime = 0;
+    latency = 0;
+    messagesPerSecond = 0;
+    evaluationsPerSecond = 0;
+    receiveBacklog = 0;
+    reportQueue = 0;
+    latencyMax = 0;
+
+    probeTimer.setTimerType(Qt::PreciseTimer);
+    probeTimer.setInterval(probeInterval);
+
+    connect(&sampleTimer, SIGNAL(timeout()), this, SLOT(sample()));
+    connect(&probeTimer, SIGNAL(timeout()), this, SLOT(probe()));
+}
+
+void DLTPerformanceMonitor::start(int interval)
+{
+    clock.start();
+    sampleTime = 0;
+    probeTime = 0;
+    latency = 0;
+    receivedMessages = dltTestRobot->getReceivedMessages();
+    matchEvaluations = dltTestRobot->getMatchEvaluations();
+
+    sampleTimer.start(interval);
+    probeTimer.start();
+}
+
+void DLTPerformanceMonitor::stop()
+{
+    sampleTimer.stop();
+    probeTimer.stop();
+}
+
+void DLTPerformanceMonitor::probe()
+{
+    qint64 now = clock.nsecsElapsed();
+
+    double delay = (now-probeTime)/1000000.0-probeInterval;
+    if(probeTime>0 && delay>latency)
+        latency = delay;
+
+    probeTime = now;
+}
+
+void DLTPerformanceMonitor::sample()
+{
+    qint64 now = clock.nsecsElapsed();
+    double seconds = (now-sampleTime)/1000000000.0;
+    sampleTime = now;
+
+    quint64 messages = dltTestRobot->getReceivedMessages();
+    quint64 evaluations = dltTestRobot->getMatchEvaluations();
+
+    if(seconds>0)
+    {
+        messagesPerSecond = (messages-receivedMessages)/seconds;
+        evaluationsPerSecond = (evaluations-matchEvaluations)/seconds;
+    }
+    receivedMessages = messages;
+    matchEvaluations = evaluations;
+
+    receiveBacklog = dltTestRobot->getReceiveBacklog();
+    reportQueue = testReport->getQueueSize();
+    matchTimes = dltTestRobot->getLastMatchTimes();
+
+    // maximum latency since the last sample
+    latencyMax = latency;
+    latency = 0;
+
+    emit updated(toString());
+}
+
+QString DLTPerformanceMonitor::toString() const
+{
+    QStringList times;
+    for(int num=0;num<matchTimes.size();num++)
+        times.append(QString::number(matchTimes[num],'f',1));
+
+    return QString("Msg/s: %1 Match/s: %2 Backlog: %3 bytes Report queue: %4 bytes Latency: %5 ms Last matches: %6 ms")
+            .arg(messagesPerSecond,0,'f',0)
+            .arg(evaluationsPerSecond,0,'f',0)
+            .arg(receiveBacklog)
+            .arg(reportQueue)
+            .arg(latencyMax,0,'f',1)
+            .arg(times.isEmpty()?QString("-"):times.join(' '));
+}
@@ -0,0 +1,79 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltperformancemonitor.h
+ * @licence end@
+ */
+#ifndef DLTPERFORMANCEMONITOR_H
+#define DLTPERFORMANCEMONITOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class DLTTestRobot;
+class DLTTestReport;
+
+// Samples the load of the test robot once per interval:
+// received messages and match evaluations per second, bytes waiting in the receive buffer,
+// bytes waiting in the report writer, time until the last finds matched and latency of the event loop.
+class DLTPerformanceMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DLTPerformanceMonitor(DLTTestRobot *dltTestRobot, DLTTestReport *testReport, QObject *parent = nullptr);
+
+    void start(int interval = 1000);
+    void stop();
+    bool isActive() const { return sampleTimer.isActive(); }
+
+    double getMessagesPerSecond() const { return messagesPerSecond; }
+    double getEvaluationsPerSecond() const { return evaluationsPerSecond; }
+    qint64 getReceiveBacklog() const { return receiveBacklog; }
+    qint64 getReportQueue() const { return reportQueue; }
+    double getLatencyMax() const { return latencyMax; }
+
+    QString toString() const;
+
+signals:
+
+    void updated(QString text);
+
+private slots:
+
+    void sample();
+    void probe();
+
+private:
+
+    DLTTestRobot *dltTestRobot;
+    DLTTestReport *testReport;
+
+    QTimer sampleTimer;
+    QTimer probeTimer;
+    QElapsedTimer clock;
+
+    qint64 sampleTime;
+    quint64 receivedMessages;
+    quint64 matchEvaluations;
+
+    // the probe timer is expected every probe interval, any delay is latency of the event loop
+    qint64 probeTime;
+    double latency;
+
+    double messagesPerSecond;
+    double evaluationsPerSecond;
+    qint64 receiveBacklog;
+    qint64 reportQueue;
+    double latencyMax;
+    QList<double> matchTimes;
+};
+
+#endif // DLTPERFORMANCEMONITOR_H
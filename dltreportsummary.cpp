@@ -0,0 +1,146 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltreportsummary.cpp
+ * @licence end@
+ */
+
+#include "dltreportsummary.h"
+
+#include <QDebug>
+
+DLTReportSummary::DLTReportSummary()
+{
+    successCount = 0;
+    failedCount = 0;
+}
+
+void DLTReportSummary::clear()
+{
+    testOrder.clear();
+    results.clear();
+    valueOrder.clear();
+    values.clear();
+    textOrder.clear();
+    texts.clear();
+    successCount = 0;
+    failedCount = 0;
+}
+
+void DLTReportSummary::setDetailFilename(const QString &filename)
+{
+    detailLog.close();
+    detailFilename = filename;
+
+    if(!detailFilename.isEmpty() && !detailLog.open(detailFilename))
+        detailFilename.clear();
+}
+
+void DLTReportSummary::close()
+{
+    detailLog.close();
+}
+
+void DLTReportSummary::addResult(const QString &testId, int testRepeatNum, int testRepeat, bool success)
+{
+    QString text = QString("%1 %2 (%3/%4)").arg(success?"SUCCESS":"FAILED").arg(testId).arg(testRepeatNum+1).arg(testRepeat);
+    detailLog.write((text+"\n").toLatin1());
+
+    if(!results.contains(testId))
+        testOrder.append(testId);
+
+    TestResult &result = results[testId];
+    result.testRepeat = testRepeat;
+    if(success)
+    {
+        result.success++;
+        successCount++;
+    }
+    else
+    {
+        result.failed++;
+        failedCount++;
+        if(result.failedRepeats.size()<MaxFailedRepeats)
+            result.failedRepeats.append(QString("%1/%2").arg(testRepeatNum+1).arg(testRepeat));
+        detailLog.flush();
+    }
+}
+
+void DLTReportSummary::addSummary(const QString &text)
+{
+    detailLog.write((text+"\n").toLatin1());
+
+    // lines ending with a number like "Measure <description> <value>" are aggregated to statistics
+    int index = text.lastIndexOf(' ');
+    bool ok = false;
+    double number = 0;
+    if(index>0)
+        number = text.mid(index+1).toDouble(&ok);
+
+    if(ok)
+    {
+        QString name = text.left(index);
+        if(!values.contains(name))
+            valueOrder.append(name);
+
+        Value &value = values[name];
+        if(value.count==0 || number<value.min)
+            value.min = number;
+        if(value.count==0 || number>value.max)
+            value.max = number;
+        value.count++;
+        value.sum += number;
+        value.last = number;
+    }
+    else
+    {
+        // other lines are counted
+        if(!texts.contains(text))
+            textOrder.append(text);
+        texts[text]++;
+    }
+}
+
+QStringList DLTReportSummary::lines() const
+{
+    QStringList list;
+
+    for(int num=0;num<testOrder.size();num++)
+    {
+        const TestResult &result = results[testOrder[num]];
+        if(result.failed==0)
+            list.append(QString("SUCCESS %1 (%2 runs)").arg(testOrder[num]).arg(result.success));
+        else
+            list.append(QString("FAILED %1 (%2 of %3 runs failed, first failed %4)").arg(testOrder[num]).arg(result.failed).arg(result.success+result.failed).arg(result.failedRepeats.join(", ")));
+    }
+
+    for(int num=0;num<valueOrder.size();num++)
+    {
+        const Value &value = values[valueOrder[num]];
+        if(value.count==1)
+            list.append(QString("%1 %2").arg(valueOrder[num]).arg(value.last));
+        else
+            list.append(QString("%1: count %2 min %3 mean %4 max %5 last %6").arg(valueOrder[num]).arg(value.count).arg(value.min).arg(value.sum/value.count).arg(value.max).arg(value.last));
+    }
+
+    for(int num=0;num<textOrder.size();num++)
+    {
+        int count = texts[textOrder[num]];
+        if(count==1)
+            list.append(textOrder[num]);
+        else
+            list.append(QString("%1 (%2 times)").arg(textOrder[num]).arg(count));
+    }
+
+    if(!detailFilename.isEmpty())
+        list.append(QString("Details: %1").arg(detailFilename));
+
+    return list;
+}
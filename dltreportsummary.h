@@ -0,0 +1,90 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltreportsummary.h
+ * @licence end@
+ */
+
+#ifndef DLTREPORTSUMMARY_H
+#define DLTREPORTSUMMARY_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+
+#include "dltreportwriter.h"
+
+// Summary of a run aggregated while the tests are running.
+// The memory depends on the number of tests and summary values, not on the number of repeats.
+// Optionally each single result is written to a detail log.
+class DLTReportSummary
+{
+public:
+    DLTReportSummary();
+
+    void clear();
+
+    // write each result and summary line to a detail log, an empty filename disables the detail log
+    void setDetailFilename(const QString &filename);
+    const QString &getDetailFilename() const { return detailFilename; }
+    void close();
+
+    void addResult(const QString &testId, int testRepeatNum, int testRepeat, bool success);
+    void addSummary(const QString &text);
+
+    int getSuccessCount() const { return successCount; }
+    int getFailedCount() const { return failedCount; }
+
+    QStringList lines() const;
+
+private:
+
+    enum { MaxFailedRepeats = 10 };
+
+    class TestResult
+    {
+    public:
+        TestResult() : success(0), failed(0), testRepeat(1) {}
+
+        int success;
+        int failed;
+        int testRepeat;
+        QStringList failedRepeats; // first failed repeats
+    };
+
+    class Value
+    {
+    public:
+        Value() : count(0), sum(0), min(0), max(0), last(0) {}
+
+        qint64 count;
+        double sum;
+        double min;
+        double max;
+        double last;
+    };
+
+    QStringList testOrder;
+    QMap<QString,TestResult> results;
+
+    QStringList valueOrder;
+    QMap<QString,Value> values;
+
+    QStringList textOrder;
+    QMap<QString,int> texts;
+
+    int successCount;
+    int failedCount;
+
+    QString detailFilename;
+    DLTReportWriter detailLog;
+};
+
+#endif // DLTREPORTSUMMARY_H
@@ -0,0 +1,153 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltreportwriter.cpp
+ * @licence end@
+ */
+
+#include "dltreportwriter.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+DLTReportWriter::DLTReportWriter(QObject *parent) : QThread(parent)
+{
+    opened = false;
+    queueBytes = 0;
+    flushRequested = false;
+    stopRequested = false;
+
+    flushSize = 64*1024;
+    flushInterval = 1000;
+    maxQueueSize = 4*1024*1024;
+}
+
+DLTReportWriter::~DLTReportWriter()
+{
+    close();
+}
+
+bool DLTReportWriter::open(const QString &filename, bool text)
+{
+    close();
+
+    this->filename = filename;
+    file.setFileName(filename);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly;
+    if(text)
+        mode |= QIODevice::Text;
+    if(!file.open(mode))
+    {
+        qDebug() << "DLTReportWriter: failed to open" << filename;
+        return false;
+    }
+
+    queue.clear();
+    queueBytes = 0;
+    flushRequested = false;
+    stopRequested = false;
+    opened = true;
+
+    start();
+
+    return true;
+}
+
+void DLTReportWriter::close()
+{
+    if(!opened)
+        return;
+
+    // write all queued data and stop the thread
+    mutex.lock();
+    stopRequested = true;
+    notEmpty.wakeAll();
+    mutex.unlock();
+
+    wait();
+
+    file.close();
+    opened = false;
+}
+
+void DLTReportWriter::write(const QByteArray &data)
+{
+    if(!opened)
+        return;
+
+    QMutexLocker locker(&mutex);
+
+    // block when the writer does not catch up
+    while(queueBytes>=maxQueueSize && !stopRequested)
+        notFull.wait(&mutex);
+
+    queue.append(data);
+    queueBytes += data.size();
+
+    if(queueBytes>=flushSize)
+        notEmpty.wakeAll();
+}
+
+void DLTReportWriter::flush()
+{
+    if(!opened)
+        return;
+
+    QMutexLocker locker(&mutex);
+
+    flushRequested = true;
+    notEmpty.wakeAll();
+}
+
+qint64 DLTReportWriter::queueSize()
+{
+    QMutexLocker locker(&mutex);
+
+    return queueBytes;
+}
+
+void DLTReportWriter::run()
+{
+    QElapsedTimer lastFlush;
+    lastFlush.start();
+    qint64 unflushed = 0;
+    bool stop = false;
+
+    while(!stop)
+    {
+        QList<QByteArray> batch;
+        bool flushNow;
+
+        mutex.lock();
+        if(!stopRequested && !flushRequested && queueBytes<flushSize)
+            notEmpty.wait(&mutex,flushInterval);
+        batch.swap(queue);
+        queueBytes = 0;
+        flushNow = flushRequested || stopRequested;
+        flushRequested = false;
+        stop = stopRequested;
+        notFull.wakeAll();
+        mutex.unlock();
+
+        // write the batch without holding the lock
+        for(int num=0;num<batch.size();num++)
+        {
+            file.write(batch[num]);
+            unflushed += batch[num].size();
+        }
+
+        if(unflushed>0 && (flushNow || unflushed>=flushSize || lastFlush.elapsed()>=flushInterval))
+        {
+            file.flush();
+            unflushed = 0;
+            lastFlush.restart();
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltreportwriter.h
+ * @licence end@
+ */
+
+#ifndef DLTREPORTWRITER_H
+#define DLTREPORTWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QList>
+#include <QByteArray>
+
+// Writes the report in a background thread.
+// The data is queued and written in batches, the file is flushed when the flush size
+// or the flush interval is reached, on request and when the report is closed.
+// The queue is bounded, when it is full the caller waits until the writer caught up.
+class DLTReportWriter : public QThread
+{
+    Q_OBJECT
+public:
+    explicit DLTReportWriter(QObject *parent = nullptr);
+    ~DLTReportWriter();
+
+    bool open(const QString &filename, bool text = true);
+    void close();
+    bool isOpen() const { return opened; }
+
+    QString fileName() const { return filename; }
+
+    void write(const QByteArray &data);
+    void flush();
+
+    // bytes waiting in the queue
+    qint64 queueSize();
+
+    void setFlushSize(qint64 size) { flushSize = size; }
+    void setFlushInterval(int interval) { flushInterval = interval; }
+    void setMaxQueueSize(qint64 size) { maxQueueSize = size; }
+
+protected:
+
+    void run() override;
+
+private:
+
+    QFile file;
+    QString filename;
+    bool opened;
+
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QList<QByteArray> queue;
+    qint64 queueBytes;
+    bool flushRequested;
+    bool stopRequested;
+
+    qint64 flushSize;
+    int flushInterval;
+    qint64 maxQueueSize;
+};
+
+#endif // DLTREPORTWRITER_H
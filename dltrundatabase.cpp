@@ -0,0 +1,305 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltrundatabase.cpp
+ * @licence end@
+ */
+
+#include "dltrundatabase.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+DLTRunDatabase::DLTRunDatabase()
+{
+    runId = -1;
+    connectionName = QString("DLTRunDatabase_%1").arg((quintptr)this);
+}
+
+DLTRunDatabase::~DLTRunDatabase()
+{
+    close();
+}
+
+bool DLTRunDatabase::open(const QString &filename)
+{
+    if(isOpen() && this->filename==filename)
+        return true;
+
+    close();
+
+    this->filename = filename;
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+
+    db = QSqlDatabase::addDatabase("QSQLITE",connectionName);
+    db.setDatabaseName(filename);
+    if(!db.open())
+    {
+        qDebug() << "DLTRunDatabase: cannot open" << filename << db.lastError().text();
+        return false;
+    }
+
+    // several instances may write to the same database
+    exec("PRAGMA journal_mode=WAL");
+    exec("PRAGMA synchronous=NORMAL");
+    exec("PRAGMA busy_timeout=5000");
+
+    exec("CREATE TABLE IF NOT EXISTS runs (id INTEGER PRIMARY KEY AUTOINCREMENT, start TEXT, end TEXT, file TEXT, version TEXT, failedTests INTEGER, failedTestCommands INTEGER)");
+    exec("CREATE TABLE IF NOT EXISTS results (run INTEGER, test TEXT, repeat INTEGER, success INTEGER, duration INTEGER, time TEXT)");
+    exec("CREATE TABLE IF NOT EXISTS measures (run INTEGER, test TEXT, name TEXT, value REAL, time TEXT)");
+    exec("CREATE TABLE IF NOT EXISTS timings (run INTEGER, command TEXT, count INTEGER, min REAL, mean REAL, max REAL, p95 REAL)");
+    exec("CREATE INDEX IF NOT EXISTS runsStart ON runs (start)");
+    exec("CREATE INDEX IF NOT EXISTS resultsTest ON results (test, time)");
+    exec("CREATE INDEX IF NOT EXISTS resultsTime ON results (time)");
+    exec("CREATE INDEX IF NOT EXISTS measuresTest ON measures (test, name, time)");
+    exec("CREATE INDEX IF NOT EXISTS measuresTime ON measures (time)");
+    exec("CREATE INDEX IF NOT EXISTS timingsRun ON timings (run)");
+
+    return true;
+}
+
+void DLTRunDatabase::close()
+{
+    if(db.isValid())
+    {
+        if(db.isOpen())
+        {
+            // measured values of the unfinished tests of an unfinished run
+            if(runId>=0 && !pendingMeasures.isEmpty() && begin())
+            {
+                for(QMap<QString,QList<DLTRunMeasure>>::const_iterator it = pendingMeasures.constBegin();it!=pendingMeasures.constEnd();++it)
+                    writeMeasures(it.key(),it.value());
+                commit();
+            }
+            db.close();
+        }
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+    runId = -1;
+    pendingMeasures.clear();
+}
+
+void DLTRunDatabase::beginRun(const QString &testsFilename, const QString &version)
+{
+    if(!isOpen())
+        return;
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO runs (start, file, version, failedTests, failedTestCommands) VALUES (?, ?, ?, 0, 0)");
+    query.addBindValue(now());
+    query.addBindValue(testsFilename);
+    query.addBindValue(version);
+    if(!query.exec())
+    {
+        qDebug() << "DLTRunDatabase: cannot add run" << query.lastError().text();
+        runId = -1;
+        return;
+    }
+    runId = query.lastInsertId().toLongLong();
+    pendingMeasures.clear();
+}
+
+void DLTRunDatabase::addResult(const QString &testId, int testRepeatNum, bool success, qint64 duration)
+{
+    if(runId<0)
+        return;
+
+    // the result and the measured values of the test are written in one short transaction,
+    // so the write lock shared with other instances is not held while the test runs
+    if(!begin())
+        return;
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO results (run, test, repeat, success, duration, time) VALUES (?, ?, ?, ?, ?, ?)");
+    query.addBindValue(runId);
+    query.addBindValue(testId);
+    query.addBindValue(testRepeatNum);
+    query.addBindValue(success?1:0);
+    query.addBindValue(duration);
+    query.addBindValue(now());
+    if(!query.exec())
+        qDebug() << "DLTRunDatabase: cannot add result" << query.lastError().text();
+
+    writeMeasures(testId,pendingMeasures.take(testId));
+
+    commit();
+}
+
+void DLTRunDatabase::addMeasure(const QString &testId, const QString &name, double value)
+{
+    if(runId<0)
+        return;
+
+    // written with the result of the test
+    DLTRunMeasure measure;
+    measure.name = name;
+    measure.value = value;
+    measure.time = now();
+    pendingMeasures[testId].append(measure);
+}
+
+void DLTRunDatabase::writeMeasures(const QString &testId, const QList<DLTRunMeasure> &measures)
+{
+    if(measures.isEmpty())
+        return;
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO measures (run, test, name, value, time) VALUES (?, ?, ?, ?, ?)");
+    for(int num=0;num<measures.size();num++)
+    {
+        query.addBindValue(runId);
+        query.addBindValue(testId);
+        query.addBindValue(measures[num].name);
+        query.addBindValue(measures[num].value);
+        query.addBindValue(measures[num].time);
+        if(!query.exec())
+            qDebug() << "DLTRunDatabase: cannot add measure" << query.lastError().text();
+    }
+}
+
+void DLTRunDatabase::endRun(int failedTests, int failedTestCommands, const QMap<QString,DLTTimingStatistics> &commandTimings)
+{
+    if(runId<0)
+        return;
+
+    if(!begin())
+    {
+        runId = -1;
+        pendingMeasures.clear();
+        return;
+    }
+
+    // measured values of tests stopped before their end
+    for(QMap<QString,QList<DLTRunMeasure>>::const_iterator it = pendingMeasures.constBegin();it!=pendingMeasures.constEnd();++it)
+        writeMeasures(it.key(),it.value());
+    pendingMeasures.clear();
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE runs SET end = ?, failedTests = ?, failedTestCommands = ? WHERE id = ?");
+    query.addBindValue(now());
+    query.addBindValue(failedTests);
+    query.addBindValue(failedTestCommands);
+    query.addBindValue(runId);
+    if(!query.exec())
+        qDebug() << "DLTRunDatabase: cannot end run" << query.lastError().text();
+
+    query.prepare("INSERT INTO timings (run, command, count, min, mean, max, p95) VALUES (?, ?, ?, ?, ?, ?, ?)");
+    for(QMap<QString,DLTTimingStatistics>::const_iterator it = commandTimings.constBegin();it!=commandTimings.constEnd();++it)
+    {
+        query.addBindValue(runId);
+        query.addBindValue(it.key());
+        query.addBindValue(it.value().getCount());
+        query.addBindValue(it.value().getMin());
+        query.addBindValue(it.value().getMean());
+        query.addBindValue(it.value().getMax());
+        query.addBindValue(it.value().percentile(95));
+        if(!query.exec())
+            qDebug() << "DLTRunDatabase: cannot add timing" << query.lastError().text();
+    }
+
+    commit();
+    runId = -1;
+}
+
+QStringList DLTRunDatabase::trend(int days)
+{
+    QStringList list;
+
+    if(!isOpen())
+        return list;
+
+    // the period is split in two halves to show the drift of durations and values
+    QDateTime current = QDateTime::currentDateTime();
+    QString from = current.addDays(-days).toString(Qt::ISODateWithMs);
+    QString middle = current.addSecs(-days*24*3600/2).toString(Qt::ISODateWithMs);
+
+    QSqlQuery query(db);
+    query.prepare("SELECT COUNT(*), SUM(CASE WHEN failedTests=0 THEN 1 ELSE 0 END) FROM runs WHERE start >= ?");
+    query.addBindValue(from);
+    if(query.exec() && query.next())
+        list.append(QString("Runs of the last %1 days: %2, without failed tests: %3").arg(days).arg(query.value(0).toInt()).arg(query.value(1).toInt()));
+
+    list.append("");
+    list.append("Test: runs, pass rate, mean duration, drift of mean duration (second half of period against first half)");
+    query.prepare("SELECT test, COUNT(*), AVG(success), AVG(duration), "
+                  "AVG(CASE WHEN time < ? THEN duration END), AVG(CASE WHEN time >= ? THEN duration END) "
+                  "FROM results WHERE time >= ? GROUP BY test ORDER BY AVG(success), test");
+    query.addBindValue(middle);
+    query.addBindValue(middle);
+    query.addBindValue(from);
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            QString drift = "-";
+            if(!query.value(4).isNull() && !query.value(5).isNull())
+                drift = QString("%1 ms").arg(query.value(5).toDouble()-query.value(4).toDouble(),0,'f',1);
+            list.append(QString("%1: %2 runs, %3% passed, %4 ms, drift %5").arg(query.value(0).toString()).arg(query.value(1).toInt()).arg(query.value(2).toDouble()*100,0,'f',1).arg(query.value(3).toDouble(),0,'f',1).arg(drift));
+        }
+    }
+    else
+        qDebug() << "DLTRunDatabase: trend query failed" << query.lastError().text();
+
+    list.append("");
+    list.append("Measure: count, min, mean, max, mean of first and second half of period");
+    query.prepare("SELECT test, name, COUNT(*), MIN(value), AVG(value), MAX(value), "
+                  "AVG(CASE WHEN time < ? THEN value END), AVG(CASE WHEN time >= ? THEN value END) "
+                  "FROM measures WHERE time >= ? GROUP BY test, name ORDER BY test, name");
+    query.addBindValue(middle);
+    query.addBindValue(middle);
+    query.addBindValue(from);
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            list.append(QString("%1 %2: %3 values, min %4, mean %5, max %6, first half %7, second half %8").arg(query.value(0).toString()).arg(query.value(1).toString()).arg(query.value(2).toInt())
+                        .arg(query.value(3).toDouble()).arg(query.value(4).toDouble()).arg(query.value(5).toDouble())
+                        .arg(query.value(6).isNull()?QString("-"):query.value(6).toString()).arg(query.value(7).isNull()?QString("-"):query.value(7).toString()));
+        }
+    }
+    else
+        qDebug() << "DLTRunDatabase: trend query failed" << query.lastError().text();
+
+    return list;
+}
+
+bool DLTRunDatabase::exec(const QString &statement)
+{
+    QSqlQuery query(db);
+    if(!query.exec(statement))
+    {
+        qDebug() << "DLTRunDatabase: failed" << statement << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DLTRunDatabase::begin()
+{
+    // the write lock is taken at the start of the transaction, a busy database fails here and not in the middle
+    return exec("BEGIN IMMEDIATE");
+}
+
+void DLTRunDatabase::commit()
+{
+    if(!exec("COMMIT"))
+        exec("ROLLBACK");
+}
+
+QString DLTRunDatabase::now()
+{
+    return QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+}
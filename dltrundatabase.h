@@ -0,0 +1,75 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dltrundatabase.h
+ * @licence end@
+ */
+
+#ifndef DLTRUNDATABASE_H
+#define DLTRUNDATABASE_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QList>
+#include <QSqlDatabase>
+
+#include "dlttimingstatistics.h"
+
+// measured value of a test, written together with the result of the test
+class DLTRunMeasure
+{
+public:
+    QString name;
+    double value;
+    QString time;
+};
+
+// SQLite database with the results, measured values and timing of all runs,
+// used for trends over many runs
+class DLTRunDatabase
+{
+public:
+    DLTRunDatabase();
+    ~DLTRunDatabase();
+
+    bool open(const QString &filename);
+    void close();
+    bool isOpen() const { return db.isOpen(); }
+
+    const QString &getFilename() const { return filename; }
+
+    void beginRun(const QString &testsFilename, const QString &version);
+    void addResult(const QString &testId, int testRepeatNum, bool success, qint64 duration);
+    void addMeasure(const QString &testId, const QString &name, double value);
+    void endRun(int failedTests, int failedTestCommands, const QMap<QString,DLTTimingStatistics> &commandTimings);
+
+    // pass rate, duration drift and measured values of the last days
+    QStringList trend(int days);
+
+private:
+
+    bool exec(const QString &statement);
+    bool begin();
+    void commit();
+    void writeMeasures(const QString &testId, const QList<DLTRunMeasure> &measures);
+
+    static QString now();
+
+    QString filename;
+    QString connectionName;
+    QSqlDatabase db;
+    qint64 runId;
+
+    // measured values of the running tests by test id
+    QMap<QString,QList<DLTRunMeasure>> pendingMeasures;
+};
+
+#endif // DLTRUNDATABASE_H
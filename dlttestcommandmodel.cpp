@@ -0,0 +1,80 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestcommandmodel.cpp
+ * @licence end@
+ */
+
+#include "dlttestcommandmodel.h"
+
+#include <QBrush>
+
+DLTTestCommandModel::DLTTestCommandModel(QObject *parent) : QAbstractListModel(parent)
+{
+    testNum = -1;
+    currentRow = -1;
+}
+
+void DLTTestCommandModel::setCommands(int testNum, const QStringList &commands)
+{
+    if(this->testNum==testNum)
+        return;
+
+    beginResetModel();
+    this->testNum = testNum;
+    this->commands = commands;
+    currentRow = -1;
+    endResetModel();
+}
+
+void DLTTestCommandModel::setCurrentRow(int row)
+{
+    if(row==currentRow)
+        return;
+
+    int oldRow = currentRow;
+    currentRow = row;
+
+    // only the old and the new highlighted row are repainted
+    if(oldRow>=0 && oldRow<commands.size())
+        emit dataChanged(index(oldRow),index(oldRow),QVector<int>() << Qt::BackgroundRole);
+    if(currentRow>=0 && currentRow<commands.size())
+        emit dataChanged(index(currentRow),index(currentRow),QVector<int>() << Qt::BackgroundRole);
+}
+
+void DLTTestCommandModel::clear()
+{
+    beginResetModel();
+    testNum = -1;
+    currentRow = -1;
+    commands.clear();
+    endResetModel();
+}
+
+int DLTTestCommandModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return commands.size();
+}
+
+QVariant DLTTestCommandModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row()>=commands.size())
+        return QVariant();
+
+    if(role==Qt::DisplayRole)
+        return commands[index.row()];
+    else if(role==Qt::BackgroundRole && index.row()==currentRow)
+        return QBrush(Qt::green);
+
+    return QVariant();
+}
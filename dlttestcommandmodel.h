@@ -0,0 +1,47 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestcommandmodel.h
+ * @licence end@
+ */
+
+#ifndef DLTTESTCOMMANDMODEL_H
+#define DLTTESTCOMMANDMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+// Commands of the current test, the current command is highlighted.
+// The list is only rebuilt when another test is shown, a new command only changes the highlighted row.
+class DLTTestCommandModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit DLTTestCommandModel(QObject *parent = nullptr);
+
+    void setCommands(int testNum, const QStringList &commands);
+    int getTestNum() const { return testNum; }
+
+    void setCurrentRow(int row);
+    int getCurrentRow() const { return currentRow; }
+
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+
+    int testNum;
+    int currentRow;
+    QStringList commands;
+};
+
+#endif // DLTTESTCOMMANDMODEL_H
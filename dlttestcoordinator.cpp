@@ -0,0 +1,240 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestcoordinator.cpp
+ * @licence end@
+ */
+
+#include "dlttestcoordinator.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QTextStream>
+#include <QCoreApplication>
+
+DLTTestCoordinator::DLTTestCoordinator(QObject *parent) : QObject(parent)
+{
+    repeat = 1;
+    running = 0;
+}
+
+DLTTestCoordinator::~DLTTestCoordinator()
+{
+    for(int num=0;num<shards.size();num++)
+    {
+        if(shards[num].process)
+        {
+            shards[num].process->kill();
+            shards[num].process->waitForFinished();
+            delete shards[num].process;
+        }
+    }
+}
+
+QStringList DLTTestCoordinator::readShards(const QString &filename)
+{
+    QStringList errors;
+    int lineCounter = 0;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "DLTTestCoordinator: failed to open file" << filename;
+        errors.append(QString("Cannot open file!"));
+        return errors;
+    }
+
+    QDir dir = QFileInfo(filename).absoluteDir();
+    QTextStream in(&file);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine().simplified();
+        lineCounter++;
+
+        if(line.size()==0 || line.at(0)==';')
+        {
+            // empty lines and comments are ignored
+        }
+        else
+        {
+            QStringList list = line.split(' ');
+            if(list[0]=="tests" && list.size()==2)
+            {
+                testsFilename = dir.absoluteFilePath(list[1]);
+            }
+            else if(list[0]=="configuration" && list.size()==2)
+            {
+                configuration = dir.absoluteFilePath(list[1]);
+            }
+            else if(list[0]=="repeat" && list.size()==2)
+            {
+                repeat = list[1].toInt();
+            }
+            else if(list[0]=="shard" && (list.size()==3 || list.size()==4))
+            {
+                // each instance needs its own DLT Mini Server port, by default 3491 for the first shard, 3492 for the second ...
+                DLTTestShard shard;
+                shard.host = list[1];
+                shard.port = list[2].toUShort();
+                shard.serverPort = (list.size()==4)?list[3].toUShort():(unsigned short)(3491+shards.size());
+                shards.append(shard);
+            }
+            else
+            {
+                errors.append(QString("ERROR: Unknown command or syntac error!"));
+                errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+            }
+        }
+    }
+    file.close();
+
+    if(testsFilename.isEmpty())
+        errors.append(QString("ERROR: tests command is missing!"));
+    if(shards.isEmpty())
+        errors.append(QString("ERROR: No shard is defined!"));
+
+    return errors;
+}
+
+bool DLTTestCoordinator::start()
+{
+    QDir().mkpath("reports");
+
+    QString prefix = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_")+QFileInfo(testsFilename).baseName();
+    mergedReportFilename = QString("reports/")+prefix+"_MergedReport.txt";
+
+    // start one robot instance for each shard, each instance executes every n-th test
+    for(int num=0;num<shards.size();num++)
+    {
+        DLTTestShard &shard = shards[num];
+
+        shard.reportFilename = QString("reports/")+prefix+QString("_Shard%1_TestReport.txt").arg(num+1);
+
+        QStringList arguments;
+        arguments << "--headless" << "--tests" << testsFilename;
+        arguments << "--repeat" << QString("%1").arg(repeat);
+        arguments << "--report" << shard.reportFilename;
+        arguments << "--host" << shard.host << "--port" << QString("%1").arg(shard.port);
+        arguments << "--server-port" << QString("%1").arg(shard.serverPort);
+        arguments << "--shard" << QString("%1/%2").arg(num).arg(shards.size());
+        if(!configuration.isEmpty())
+            arguments << configuration;
+
+        shard.process = new QProcess();
+        shard.process->setProcessChannelMode(QProcess::ForwardedChannels);
+        connect(shard.process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(processFinished(int,QProcess::ExitStatus)));
+        shard.process->start(QCoreApplication::applicationFilePath(),arguments);
+        if(!shard.process->waitForStarted())
+        {
+            qDebug() << "DLTTestCoordinator: cannot start shard" << num+1;
+            return false;
+        }
+        running++;
+
+        qDebug() << "DLTTestCoordinator: started shard" << num+1 << shard.host << shard.port << "server port" << shard.serverPort;
+    }
+
+    return true;
+}
+
+void DLTTestCoordinator::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QProcess *process = qobject_cast<QProcess*>(sender());
+
+    for(int num=0;num<shards.size();num++)
+    {
+        if(shards[num].process==process)
+        {
+            shards[num].exitCode = (exitStatus==QProcess::NormalExit)?exitCode:-1;
+            qDebug() << "DLTTestCoordinator: shard finished" << num+1 << shards[num].exitCode;
+        }
+    }
+
+    running--;
+    if(running>0)
+        return;
+
+    mergeReports();
+
+    int result = 0;
+    for(int num=0;num<shards.size();num++)
+    {
+        if(shards[num].exitCode!=0)
+            result = 1;
+    }
+
+    emit finished(result);
+}
+
+void DLTTestCoordinator::mergeReports()
+{
+    QStringList summary;
+    int successTests = 0;
+    int failedTests = 0;
+    int failedTestCommands = 0;
+
+    for(int num=0;num<shards.size();num++)
+    {
+        QFile file(shards[num].reportFilename);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            summary.append(QString("Shard %1: report missing").arg(num+1));
+            continue;
+        }
+
+        // collect the summary section and the counters of each report
+        bool isSummary = false;
+        QTextStream in(&file);
+        while (!in.atEnd())
+        {
+            QString line = in.readLine();
+
+            if(line=="Summary")
+                isSummary = true;
+            else if(line.isEmpty())
+                isSummary = false;
+            else if(isSummary)
+                summary.append(QString("Shard %1: %2").arg(num+1).arg(line));
+            else if(line.startsWith("Success tests: "))
+                successTests += line.mid(15).toInt();
+            else if(line.startsWith("Failed tests: "))
+                failedTests += line.mid(14).toInt();
+            else if(line.startsWith("Failed test commands: "))
+                failedTestCommands += line.mid(22).toInt();
+        }
+        file.close();
+    }
+
+    QFile file(mergedReportFilename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qDebug() << "DLTTestCoordinator: cannot write" << mergedReportFilename;
+        return;
+    }
+
+    QDateTime dateTime = QDateTime::currentDateTime();
+    file.write(QString("Merged report at %1 %2\n").arg(dateTime.toString("dd.MM.yyyy")).arg(dateTime.toString("HH:mm:ss")).toLatin1());
+    file.write(QString("\nTest File: %1\n\n").arg(testsFilename).toLatin1());
+    for(int num=0;num<shards.size();num++)
+    {
+        file.write(QString("Shard %1: %2:%3 server port %4 exit code %5 report %6\n").arg(num+1).arg(shards[num].host).arg(shards[num].port).arg(shards[num].serverPort).arg(shards[num].exitCode).arg(shards[num].reportFilename).toLatin1());
+    }
+    file.write(QString("\nSummary\n").toLatin1());
+    for(int num=0;num<summary.size();num++)
+    {
+        file.write((summary[num]+"\n").toLatin1());
+    }
+    file.write(QString("\nSuccess tests: %1\nFailed tests: %2\nFailed test commands: %3\n").arg(successTests).arg(failedTests).arg(failedTestCommands).toLatin1());
+    file.close();
+
+    qDebug() << "DLTTestCoordinator: merged report" << mergedReportFilename;
+}
@@ -0,0 +1,72 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestcoordinator.h
+ * @licence end@
+ */
+
+#ifndef DLTTESTCOORDINATOR_H
+#define DLTTESTCOORDINATOR_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+class DLTTestShard
+{
+public:
+    DLTTestShard() : port(4490), serverPort(0), process(0), exitCode(-1) {}
+
+    QString host;
+    unsigned short port;
+    unsigned short serverPort; // port of the DLT Mini Server of the instance
+    QString reportFilename;
+    QProcess *process;
+    int exitCode;
+};
+
+// Distributes all tests to several DLTTestRobot instances, each connected to its own DLT Viewer,
+// and merges the reports of all instances
+class DLTTestCoordinator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DLTTestCoordinator(QObject *parent = nullptr);
+    ~DLTTestCoordinator();
+
+    QStringList readShards(const QString &filename);
+
+    bool start();
+
+    const QString &getMergedReportFilename() const { return mergedReportFilename; }
+
+signals:
+
+    void finished(int exitCode);
+
+private slots:
+
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+
+    void mergeReports();
+
+    QString testsFilename;
+    QString configuration;
+    int repeat;
+
+    QList<DLTTestShard> shards;
+    int running;
+
+    QString mergedReportFilename;
+};
+
+#endif // DLTTESTCOORDINATOR_H
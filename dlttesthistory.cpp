@@ -0,0 +1,117 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttesthistory.cpp
+ * @licence end@
+ */
+
+#include "dlttesthistory.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QXmlStreamWriter>
+#include <QXmlStreamReader>
+
+DLTTestHistory::DLTTestHistory()
+{
+}
+
+void DLTTestHistory::clear()
+{
+    entries.clear();
+}
+
+void DLTTestHistory::load(const QString &filename)
+{
+    this->filename = filename;
+    entries.clear();
+
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+             return;
+
+    QXmlStreamReader xml(&file);
+
+    while (!xml.atEnd())
+    {
+          xml.readNext();
+
+          if(xml.isStartElement() && xml.name() == QString("test"))
+          {
+              QXmlStreamAttributes attributes = xml.attributes();
+              DLTTestHistoryEntry entry;
+              entry.runs = attributes.value("runs").toInt();
+              entry.failures = attributes.value("failures").toInt();
+              entry.failScore = attributes.value("failScore").toDouble();
+              entry.lastDuration = attributes.value("lastDuration").toLongLong();
+              entry.meanDuration = attributes.value("meanDuration").toDouble();
+              entries.insert(attributes.value("id").toString(),entry);
+          }
+    }
+    if (xml.hasError())
+    {
+         qDebug() << "Error in processing history file" << filename << xml.errorString();
+    }
+
+    file.close();
+
+    qDebug() << "DLTTestHistory: loaded" << entries.size() << "tests from" << filename;
+}
+
+void DLTTestHistory::save()
+{
+    if(filename.isEmpty())
+        return;
+
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+
+    QFile file(filename);
+    if (!file.open(QFile::WriteOnly | QFile::Text))
+    {
+        qDebug() << "DLTTestHistory: cannot write" << filename;
+        return;
+    }
+
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+
+    xml.writeStartElement("DLTTestHistory");
+    for(QMap<QString,DLTTestHistoryEntry>::const_iterator it = entries.constBegin();it!=entries.constEnd();++it)
+    {
+        xml.writeStartElement("test");
+        xml.writeAttribute("id",it.key());
+        xml.writeAttribute("runs",QString("%1").arg(it.value().runs));
+        xml.writeAttribute("failures",QString("%1").arg(it.value().failures));
+        xml.writeAttribute("failScore",QString("%1").arg(it.value().failScore));
+        xml.writeAttribute("lastDuration",QString("%1").arg(it.value().lastDuration));
+        xml.writeAttribute("meanDuration",QString("%1").arg(it.value().meanDuration));
+        xml.writeEndElement(); // test
+    }
+    xml.writeEndElement(); // DLTTestHistory
+
+    file.close();
+}
+
+void DLTTestHistory::record(const QString &id, bool success, qint64 duration)
+{
+    DLTTestHistoryEntry &entry = entries[id];
+
+    entry.runs++;
+    if(!success)
+        entry.failures++;
+
+    // each run halves the weight of older failures
+    entry.failScore = entry.failScore/2 + (success?0:1);
+
+    entry.lastDuration = duration;
+    entry.meanDuration += (duration-entry.meanDuration)/entry.runs;
+}
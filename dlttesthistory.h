@@ -0,0 +1,56 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttesthistory.h
+ * @licence end@
+ */
+
+#ifndef DLTTESTHISTORY_H
+#define DLTTESTHISTORY_H
+
+#include <QString>
+#include <QMap>
+
+class DLTTestHistoryEntry
+{
+public:
+    DLTTestHistoryEntry() : runs(0), failures(0), failScore(0), lastDuration(0), meanDuration(0) {}
+
+    int runs;
+    int failures;
+    double failScore;   // weighted failures, recent runs count most
+    qint64 lastDuration;
+    double meanDuration;
+};
+
+// Duration and failures of previous runs of each test, stored in an XML file
+class DLTTestHistory
+{
+public:
+    DLTTestHistory();
+
+    void clear();
+    void load(const QString &filename);
+    void save();
+
+    void record(const QString &id, bool success, qint64 duration);
+
+    bool contains(const QString &id) const { return entries.contains(id); }
+    DLTTestHistoryEntry entry(const QString &id) const { return entries.value(id); }
+
+    const QString &getFilename() const { return filename; }
+
+private:
+
+    QString filename;
+    QMap<QString,DLTTestHistoryEntry> entries;
+};
+
+#endif // DLTTESTHISTORY_H
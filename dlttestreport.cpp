@@ -0,0 +1,200 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestreport.cpp
+ * @licence end@
+ */
+
+#include "dlttestreport.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+DLTTestReport::DLTTestReport(DLTTestRobot *dltTestRobot, DLTMiniServer *dltMiniServer, QObject *parent) : QObject(parent)
+{
+    this->dltTestRobot = dltTestRobot;
+    this->dltMiniServer = dltMiniServer;
+
+    connect(dltTestRobot, SIGNAL(report(QString)), this, SLOT(report(QString)));
+    connect(dltTestRobot, SIGNAL(reportSummary(QString)), this, SLOT(reportSummary(QString)));
+    connect(dltTestRobot, SIGNAL(measured(QString,int,QString,double)), this, SLOT(measured(QString,int,QString,double)));
+    connect(dltTestRobot, SIGNAL(command(int,int,int,int,int,int,int,QString)), this, SLOT(command(int,int,int,int,int,int,int,QString)));
+    connect(dltTestRobot, SIGNAL(resumedResult(int,int,int,bool)), this, SLOT(resumedResult(int,int,int,bool)));
+}
+
+DLTTestReport::~DLTTestReport()
+{
+    // write the queued report data
+    reportFile.close();
+}
+
+void DLTTestReport::open(const QString &name, const QString &filename, bool detailLog, bool dltFile)
+{
+    // create and write to report
+    QTime time = QTime::currentTime();
+    QDate date = QDate::currentDate();
+    if(reportFile.isOpen())
+        reportFile.close();
+    summary.clear();
+    if(!filename.isEmpty())
+        reportFile.open(filename);
+    else
+        reportFile.open(date.toString("reports\\yyyyMMdd_")+time.toString("HHmmss_")+name+"_TestReport.txt");
+    reportFile.write(QString("Starting tests at %1 %2\n").arg(date.toString("dd.MM.yyyy")).arg(time.toString("HH:mm:ss")).toLatin1());
+    reportFile.write(QString("\nTest File: %1\n").arg(dltTestRobot->getTestsFilename()).toLatin1());
+    reportFile.write(QString("\nTest Version: %1\n\n").arg(dltTestRobot->getVersion()).toLatin1());
+
+    QString baseName = QFileInfo(reportFile.fileName()).path()+"/"+QFileInfo(reportFile.fileName()).completeBaseName();
+    resultWriter.open(reportFile.fileName(),dltTestRobot->getTestsFilename(),dltTestRobot->getVersion());
+    timeSeries.setDownsampling(dltTestRobot->getMeasureDownsampling());
+    timeSeries.open(baseName+"_Measures.bin");
+    if(detailLog)
+        summary.setDetailFilename(baseName+"_Details.txt");
+    else
+        summary.setDetailFilename(QString());
+    if(dltFile)
+        dltMiniServer->openFile(baseName+".dlt");
+
+    // open new DLt file and connect all ECUs
+    dltTestRobot->send(QString("newFile ")+QDir::currentPath()+date.toString("\\reports\\yyyyMMdd_")+time.toString("HHmmss_")+name+"_Logs.dlt");
+    dltTestRobot->send(QString("connectAllEcu"));
+
+    dltMiniServer->sendValue2("Tests start",QFileInfo(dltTestRobot->getTestsFilename()).baseName());
+}
+
+void DLTTestReport::close()
+{
+    if(!reportFile.isOpen())
+        return;
+
+    // write summary and close report
+    writeSummaryToReport();
+    reportFile.close();
+    resultWriter.close(summary.getSuccessCount(),summary.getFailedCount(),dltTestRobot->getFailedTestCommands());
+    summary.close();
+    timeSeries.close();
+    dltMiniServer->closeFile();
+
+    emit closed();
+}
+
+int DLTTestReport::exitCode() const
+{
+    return (summary.getFailedCount()>0 || dltTestRobot->getFailedTestCommands()>0)?1:0;
+}
+
+void DLTTestReport::writeSummaryToReport()
+{
+    // write summary
+    QTime time = QTime::currentTime();
+    QDate date = QDate::currentDate();
+    reportFile.write(QString("\nSummary\n").toLatin1());
+    QStringList lines = summary.lines();
+    for(int num=0;num<lines.size();num++)
+    {
+        reportFile.write((lines[num]+"\n").toLatin1());
+    }
+    reportFile.write(QString("\nSuccess tests: %1\nFailed tests: %2\nFailed test commands: %3\n").arg(summary.getSuccessCount()).arg(summary.getFailedCount()).arg(dltTestRobot->getFailedTestCommands()).toLatin1());
+    reportFile.write(QString("Timer jitter: %1 timers, mean %2 ms, max %3 ms\n").arg(dltTestRobot->getJitterCount()).arg(dltTestRobot->getJitterMean(),0,'f',3).arg(dltTestRobot->getJitterMax(),0,'f',3).toLatin1());
+    reportFile.write(QString("\n%1\n").arg(dltTestRobot->getTimingSummary().join('\n')).toLatin1());
+    reportFile.write(QString("\nTests STOPPED at %1 %2\n").arg(date.toString("dd.MM.yyyy")).arg(time.toString("HH:mm:ss")).toLatin1());
+}
+
+void DLTTestReport::report(QString text)
+{
+    // write to report
+    QTime time = QTime::currentTime();
+    reportFile.write(QString("=> %1 %2\n").arg(time.toString("HH:mm:ss")).arg(text).toLatin1());
+    resultWriter.report(text);
+}
+
+void DLTTestReport::reportSummary(QString text)
+{
+    // aggregate to summary
+    summary.addSummary(text);
+}
+
+void DLTTestReport::measured(QString testId, int repeat, QString name, double value)
+{
+    // write to time series
+    timeSeries.add(testId,repeat,name,value);
+}
+
+void DLTTestReport::command(int allTestRepeatNum,int allTestRepeat, int testRepeatNum,int testRepeat,int testNum, int commandNum,int commandCount, QString text)
+{
+    Q_UNUSED(allTestRepeatNum);
+    Q_UNUSED(allTestRepeat);
+    Q_UNUSED(commandCount);
+
+    if(text=="started")
+    {
+        dltMiniServer->sendValue2("test start",dltTestRobot->testId(testNum));
+
+        // write to report
+        QTime time = QTime::currentTime();
+        reportFile.write(QString("\n%1 test start %2 (%3/%4)\n").arg(time.toString("HH:mm:ss")).arg(dltTestRobot->testId(testNum)).arg(testRepeatNum+1).arg(testRepeat).toLatin1());
+        resultWriter.start(testNum,dltTestRobot->testId(testNum),dltTestRobot->testDescription(testNum),testRepeatNum,testRepeat);
+    }
+    else if(text=="end success")
+    {
+        dltMiniServer->sendValue2("test end success",dltTestRobot->testId(testNum));
+
+        // write to report
+        QTime time = QTime::currentTime();
+        reportFile.write(QString("%1 test end SUCCESS\n").arg(time.toString("HH:mm:ss")).toLatin1());
+        resultWriter.end(testNum,true);
+
+        summary.addResult(dltTestRobot->testId(testNum),testRepeatNum,testRepeat,true);
+    }
+    else if(text=="end")
+    {
+        // includes the number of test steps suppressed in the last second
+        dltMiniServer->flush();
+        dltMiniServer->sendValue2("Tests end",QFileInfo(dltTestRobot->getTestsFilename()).baseName());
+
+        close();
+    }
+    else if(text=="failed")
+    {
+        dltMiniServer->sendValue2("test failed",dltTestRobot->testId(testNum),DLT_LOG_FATAL);
+
+        // write to report
+        QTime time = QTime::currentTime();
+        reportFile.write(QString("%1 test FAILED\n").arg(time.toString("HH:mm:ss")).toLatin1());
+        // keep the failure on disk even if the application crashes
+        reportFile.flush();
+        resultWriter.end(testNum,false);
+
+        summary.addResult(dltTestRobot->testId(testNum),testRepeatNum,testRepeat,false);
+        dltTestRobot->send(QString("marker"));
+    }
+    else if(text=="stopped")
+    {
+        close();
+    }
+    else
+    {
+        dltMiniServer->sendStep(QString("%1").arg(commandNum),text);
+
+        // write to report
+        QTime time = QTime::currentTime();
+        reportFile.write(QString("%1 test step %2 %3\n").arg(time.toString("HH:mm:ss")).arg(commandNum).arg(text).toLatin1());
+        resultWriter.step(testNum,commandNum,text);
+    }
+}
+
+void DLTTestReport::resumedResult(int testNum, int testRepeatNum, int testRepeat, bool success)
+{
+    // restore the summary of tests completed before the run was interrupted
+    resultWriter.resumed(dltTestRobot->testId(testNum),testRepeatNum,testRepeat,success);
+    summary.addResult(dltTestRobot->testId(testNum),testRepeatNum,testRepeat,success);
+}
@@ -0,0 +1,77 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestreport.h
+ * @licence end@
+ */
+
+#ifndef DLTTESTREPORT_H
+#define DLTTESTREPORT_H
+
+#include <QObject>
+
+#include "dlttestrobot.h"
+#include "dltminiserver.h"
+#include "dltreportsummary.h"
+#include "dltreportwriter.h"
+#include "dlttestresultwriter.h"
+#include "dlttimeserieswriter.h"
+
+// Report of a test run, used by the dialog and the headless runner.
+// Writes the text report, the summary, the JUnit XML, JSON Lines and time series files
+// and sends the test events to the DLT Viewer and the DLT output.
+class DLTTestReport : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DLTTestReport(DLTTestRobot *dltTestRobot, DLTMiniServer *dltMiniServer, QObject *parent = nullptr);
+    ~DLTTestReport();
+
+    // name is the name of the tests used in the report filename, filename overrides the default report filename,
+    // with dltFile the DLT messages of the DLT Mini Server are written to <report>.dlt
+    void open(const QString &name, const QString &filename = QString(), bool detailLog = false, bool dltFile = false);
+    void close();
+    bool isOpen() const { return reportFile.isOpen(); }
+
+    int getSuccessCount() const { return summary.getSuccessCount(); }
+    int getFailedCount() const { return summary.getFailedCount(); }
+
+    // number of bytes waiting to be written to the report file
+    qint64 getQueueSize() { return reportFile.queueSize(); }
+
+    // exit code of a run without user interaction, 0 when all tests succeeded
+    int exitCode() const;
+
+signals:
+
+    void closed();
+
+private slots:
+
+    void report(QString text);
+    void reportSummary(QString text);
+    void measured(QString testId, int repeat, QString name, double value);
+    void command(int allTestRepeatNum,int allTestRepeat, int testRepeatNum,int testRepeat,int testNum, int commandNum,int commandCount, QString text);
+    void resumedResult(int testNum, int testRepeatNum, int testRepeat, bool success);
+
+private:
+
+    void writeSummaryToReport();
+
+    DLTTestRobot *dltTestRobot;
+    DLTMiniServer *dltMiniServer;
+
+    DLTReportWriter reportFile;
+    DLTTestResultWriter resultWriter;
+    DLTTimeSeriesWriter timeSeries;
+    DLTReportSummary summary;
+};
+
+#endif // DLTTESTREPORT_H
@@ -0,0 +1,243 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestresultwriter.cpp
+ * @licence end@
+ */
+
+#include "dlttestresultwriter.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QDebug>
+
+DLTTestResultWriter::DLTTestResultWriter()
+{
+    countsOffset = 0;
+    testCount = 0;
+    failureCount = 0;
+    startTime = 0;
+}
+
+DLTTestResultWriter::~DLTTestResultWriter()
+{
+    if(isOpen())
+        close(0,0,0);
+}
+
+void DLTTestResultWriter::open(const QString &reportFilename, const QString &testsFilename, const QString &version)
+{
+    QFileInfo info(reportFilename);
+    QString base = info.path()+"/"+info.completeBaseName();
+
+    running.clear();
+    suiteName = QFileInfo(testsFilename).baseName();
+    testCount = 0;
+    failureCount = 0;
+    startTime = QDateTime::currentMSecsSinceEpoch();
+
+    // binary mode, the offset of the counts must not change by line ending conversion
+    if(!junit.open(base+".xml",false))
+        qDebug() << "DLTTestResultWriter: failed to open JUnit report" << base+".xml";
+    if(!jsonl.open(base+".jsonl"))
+        qDebug() << "DLTTestResultWriter: failed to open JSON Lines report" << base+".jsonl";
+
+    // the counts of the testsuite are written with fixed width and updated when the report is closed
+    QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+    QByteArray header = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    header += QString("<testsuites name=\"%1\">\n").arg(escape(suiteName)).toUtf8();
+    header += QString("<testsuite name=\"%1\" timestamp=\"%2\" ").arg(escape(suiteName)).arg(timestamp).toUtf8();
+    countsOffset = header.size();
+    header += counts(0,0,0)+">\n";
+    junit.write(header);
+    junit.write(QString("<properties><property name=\"file\" value=\"%1\"/><property name=\"version\" value=\"%2\"/></properties>\n").arg(escape(testsFilename)).arg(escape(version)).toUtf8());
+
+    QJsonObject object;
+    object["file"] = testsFilename;
+    object["version"] = version;
+    writeEvent("run start",object);
+}
+
+void DLTTestResultWriter::close(int successCount, int failedCount, int failedCommands)
+{
+    if(!isOpen())
+        return;
+
+    // tests still running when the run was stopped
+    QMapIterator<int,RunningTest> iterator(running);
+    while(iterator.hasNext())
+    {
+        iterator.next();
+        const RunningTest &test = iterator.value();
+        writeTestCase(QString("%1 (%2/%3)").arg(test.id).arg(test.testRepeatNum+1).arg(test.testRepeat),(QDateTime::currentMSecsSinceEpoch()-test.start)/1000.0,false,"stopped at "+test.command);
+    }
+    running.clear();
+
+    junit.write("</testsuite>\n</testsuites>\n");
+    QString junitFilename = junit.fileName();
+    double duration = (QDateTime::currentMSecsSinceEpoch()-startTime)/1000.0;
+
+    QJsonObject object;
+    object["success"] = successCount;
+    object["failed"] = failedCount;
+    object["failedCommands"] = failedCommands;
+    writeEvent("run end",object);
+
+    junit.close();
+    jsonl.close();
+
+    // update the counts of the testsuite, the written values have the same size
+    QFile file(junitFilename);
+    if(file.open(QFile::ReadWrite) && file.seek(countsOffset))
+        file.write(counts(testCount,failureCount,duration));
+    else
+        qDebug() << "DLTTestResultWriter: failed to update JUnit report" << junitFilename;
+}
+
+QByteArray DLTTestResultWriter::counts(int tests, int failures, double time)
+{
+    return QString("tests=\"%1\" failures=\"%2\" time=\"%3\"")
+            .arg(tests,10,10,QChar('0'))
+            .arg(failures,10,10,QChar('0'))
+            .arg(QString::number(time,'f',3).rightJustified(14,'0')).toLatin1();
+}
+
+void DLTTestResultWriter::start(int testNum, const QString &id, const QString &description, int testRepeatNum, int testRepeat)
+{
+    if(!isOpen())
+        return;
+
+    RunningTest test;
+    test.id = id;
+    test.start = QDateTime::currentMSecsSinceEpoch();
+    test.testRepeatNum = testRepeatNum;
+    test.testRepeat = testRepeat;
+    running[testNum] = test;
+
+    QJsonObject object;
+    object["test"] = id;
+    object["description"] = description;
+    object["repeat"] = testRepeatNum+1;
+    object["repeats"] = testRepeat;
+    writeEvent("test start",object);
+}
+
+void DLTTestResultWriter::step(int testNum, int commandNum, const QString &text)
+{
+    if(!isOpen())
+        return;
+
+    QMap<int,RunningTest>::iterator iterator = running.find(testNum);
+    if(iterator==running.end())
+        return;
+
+    iterator->commandNum = commandNum;
+    iterator->command = text;
+
+    QJsonObject object;
+    object["test"] = iterator->id;
+    object["step"] = commandNum;
+    object["command"] = text;
+    writeEvent("test step",object);
+}
+
+void DLTTestResultWriter::end(int testNum, bool success)
+{
+    if(!isOpen())
+        return;
+
+    QMap<int,RunningTest>::iterator iterator = running.find(testNum);
+    if(iterator==running.end())
+        return;
+
+    double duration = (QDateTime::currentMSecsSinceEpoch()-iterator->start)/1000.0;
+
+    writeTestCase(QString("%1 (%2/%3)").arg(iterator->id).arg(iterator->testRepeatNum+1).arg(iterator->testRepeat),duration,success,QString("step %1 %2").arg(iterator->commandNum).arg(iterator->command));
+
+    QJsonObject object;
+    object["test"] = iterator->id;
+    object["repeat"] = iterator->testRepeatNum+1;
+    object["repeats"] = iterator->testRepeat;
+    object["result"] = success?"success":"failed";
+    object["duration"] = duration;
+    if(!success)
+    {
+        object["step"] = iterator->commandNum;
+        object["command"] = iterator->command;
+    }
+    writeEvent("test end",object);
+
+    running.erase(iterator);
+
+    if(!success)
+        flush();
+}
+
+void DLTTestResultWriter::resumed(const QString &id, int testRepeatNum, int testRepeat, bool success)
+{
+    if(!isOpen())
+        return;
+
+    // result of a test completed before the run was interrupted
+    writeTestCase(QString("%1 (%2/%3)").arg(id).arg(testRepeatNum+1).arg(testRepeat),0,success,"failed before resume");
+
+    QJsonObject object;
+    object["test"] = id;
+    object["repeat"] = testRepeatNum+1;
+    object["repeats"] = testRepeat;
+    object["result"] = success?"success":"failed";
+    writeEvent("test resumed",object);
+}
+
+void DLTTestResultWriter::report(const QString &text)
+{
+    if(!isOpen())
+        return;
+
+    QJsonObject object;
+    object["text"] = text;
+    writeEvent("report",object);
+}
+
+void DLTTestResultWriter::flush()
+{
+    junit.flush();
+    jsonl.flush();
+}
+
+void DLTTestResultWriter::writeEvent(const QString &event, QJsonObject object)
+{
+    object["event"] = event;
+    object["time"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    jsonl.write(QJsonDocument(object).toJson(QJsonDocument::Compact)+"\n");
+}
+
+void DLTTestResultWriter::writeTestCase(const QString &name, double duration, bool success, const QString &failure)
+{
+    testCount++;
+    if(!success)
+        failureCount++;
+
+    QString text = QString("<testcase name=\"%1\" classname=\"%2\" time=\"%3\"").arg(escape(name)).arg(escape(suiteName)).arg(duration,0,'f',3);
+    if(success)
+        text += "/>\n";
+    else
+        text += QString("><failure message=\"%1\"/></testcase>\n").arg(escape(failure));
+    junit.write(text.toUtf8());
+}
+
+QString DLTTestResultWriter::escape(const QString &text)
+{
+    QString escaped = text.toHtmlEscaped();
+    escaped.replace('\n',"&#10;");
+    return escaped;
+}
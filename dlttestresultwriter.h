@@ -0,0 +1,79 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestresultwriter.h
+ * @licence end@
+ */
+
+#ifndef DLTTESTRESULTWRITER_H
+#define DLTTESTRESULTWRITER_H
+
+#include <QString>
+#include <QMap>
+#include <QJsonObject>
+
+#include "dltreportwriter.h"
+
+// Streams the test results as JUnit XML and JSON Lines while the tests are running.
+// Only the state of the running tests is kept in memory.
+class DLTTestResultWriter
+{
+public:
+    DLTTestResultWriter();
+    ~DLTTestResultWriter();
+
+    // the files are named after the text report with the extensions .xml and .jsonl
+    void open(const QString &reportFilename, const QString &testsFilename, const QString &version);
+    void close(int successCount, int failedCount, int failedCommands);
+    bool isOpen() const { return junit.isOpen(); }
+
+    void start(int testNum, const QString &id, const QString &description, int testRepeatNum, int testRepeat);
+    void step(int testNum, int commandNum, const QString &text);
+    void end(int testNum, bool success);
+    void resumed(const QString &id, int testRepeatNum, int testRepeat, bool success);
+    void report(const QString &text);
+
+    void flush();
+
+private:
+
+    class RunningTest
+    {
+    public:
+        RunningTest() : start(0), testRepeatNum(0), testRepeat(1), commandNum(-1) {}
+
+        QString id;
+        qint64 start;
+        int testRepeatNum;
+        int testRepeat;
+        int commandNum;
+        QString command; // last executed command, reported as failure message
+    };
+
+    void writeEvent(const QString &event, QJsonObject object);
+    void writeTestCase(const QString &name, double duration, bool success, const QString &failure);
+
+    static QString escape(const QString &text);
+    static QByteArray counts(int tests, int failures, double time);
+
+    DLTReportWriter junit;
+    DLTReportWriter jsonl;
+
+    QString suiteName;
+
+    // counts of the testsuite
+    qint64 countsOffset;
+    int testCount;
+    int failureCount;
+    qint64 startTime;
+    QMap<int,RunningTest> running;
+};
+
+#endif // DLTTESTRESULTWRITER_H
@@ -18,6 +18,13 @@
 #include <QFile>
 #include <QSerialPortInfo>
 #include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QDir>
+#include <QCryptographicHash>
+#include <QtConcurrent>
+
+#include <algorithm>
 
 DLTTest::DLTTest()
 {
@@ -34,6 +41,10 @@ DLTTest& DLTTest::operator=(DLTTest &test)
     commands = test.commands;
     id = test.id;
     description = test.description;
+    bindings = test.bindings;
+    lane = test.lane;
+    repeat = test.repeat;
+    fail = test.fail;
 
     return *this;
 }
@@ -41,6 +52,8 @@ DLTTest& DLTTest::operator=(DLTTest &test)
 void DLTTest::clear()
 {
     commands.clear();
+    bindings.clear();
+    lane="";
     id="";
     description="";
     repeat = 1;
@@ -82,6 +95,75 @@ const QStringList &DLTTest::getCommands() const
     return commands;
 }
 
+QStringList DLTTest::getExpandedCommands() const
+{
+    if(bindings.isEmpty())
+        return commands;
+
+    QStringList list;
+    for(int num=0;num<commands.size();num++)
+        list.append(expand(commands[num]));
+
+    return list;
+}
+
+const QMap<QString,QString> &DLTTest::getBindings() const
+{
+    return bindings;
+}
+
+void DLTTest::setBindings(const QMap<QString,QString> &value)
+{
+    bindings = value;
+}
+
+QStringList DLTTest::getVariables() const
+{
+    // collect all variables ${NAME} used in the description and the commands
+    static const QRegularExpression variable("\\$\\{(\\w+)\\}");
+
+    QStringList texts = commands;
+    texts.prepend(description);
+
+    QStringList variables;
+    for(int num=0;num<texts.size();num++)
+    {
+        QRegularExpressionMatchIterator it = variable.globalMatch(texts[num]);
+        while(it.hasNext())
+        {
+            QString name = it.next().captured(1);
+            if(!variables.contains(name))
+                variables.append(name);
+        }
+    }
+
+    return variables;
+}
+
+QString DLTTest::expand(const QString &text) const
+{
+    if(!text.contains("${"))
+        return text;
+
+    QString result = text;
+    for(QMap<QString,QString>::const_iterator it = bindings.constBegin();it!=bindings.constEnd();++it)
+    {
+        result.replace(QString("${%1}").arg(it.key()),it.value());
+    }
+
+    return result;
+}
+
+const QString &DLTTest::getLane() const
+{
+    return lane;
+}
+
+void DLTTest::setLane(const QString &newLane)
+{
+    lane = newLane;
+}
+
 const QString &DLTTest::getFail() const
 {
     return fail;
@@ -93,8 +175,112 @@ void DLTTest::setFail(const QString &newFail)
 }
 
 
+DLTTestCommand::DLTTestCommand()
+{
+    type = Send;
+    time = 0;
+    timeMax = 0;
+    value = 0;
+}
+
+DLTTestCommand::DLTTestCommand(const QString &line)
+{
+    text = line;
+    type = Send;
+    time = 0;
+    timeMax = 0;
+    value = 0;
+
+    QStringList list = line.split(' ');
+
+    if(list.size()>=2 && list[0]=="wait")
+    {
+        // wait <time> or wait <min> <max>
+        time = list[1].toUInt();
+        if(list.size()==3)
+        {
+            type = WaitRandom;
+            timeMax = list[2].toUInt();
+        }
+        else
+            type = Wait;
+    }
+    else if(list.size()>=3 && list[0]=="find")
+    {
+        // find <type> <time> <ecuId> <appId> <ctxId> <text> or <valueId> <value>
+        time = list[2].toUInt();
+        if(list[1]=="unequal")
+            type = FindUnequal;
+        else if(list[1]=="greater")
+            type = FindGreater;
+        else if(list[1]=="smaller")
+            type = FindSmaller;
+        else
+            type = FindEqual;
+        if(list.size()>=7)
+        {
+            ecuId = list[3];
+            appId = list[4];
+            ctxId = list[5];
+            if(type==FindEqual || type==FindUnequal)
+                pattern = QStringList(list.mid(6)).join(' ');
+            else
+                valueId = list[6];
+        }
+        if(list.size()>=8)
+            value = list[7].toFloat();
+    }
+    else if(list.size()>=2 && list[0]=="measure")
+    {
+        // measure <time> <ecuId> <appId> <ctxId> <valueId> <description>, the description is one word
+        type = Measure;
+        time = list[1].toUInt();
+        if(list.size()==7)
+        {
+            ecuId = list[2];
+            appId = list[3];
+            ctxId = list[4];
+            valueId = list[5];
+            pattern = list[6];
+        }
+    }
+}
+
+QString DLTTestCommand::typeName() const
+{
+    switch(type)
+    {
+    case Send: return "send";
+    case Wait: return "wait";
+    case WaitRandom: return "wait random";
+    case FindEqual: return "find equal";
+    case FindUnequal: return "find unequal";
+    case FindGreater: return "find greater";
+    case FindSmaller: return "find smaller";
+    case Measure: return "measure";
+    }
+
+    return QString();
+}
+
 DLTTestRobot::DLTTestRobot(QObject *parent) : QObject(parent)
 {
+    stateTimeout = 0;
+    readyRequest = 0;
+    shardIndex = 0;
+    shardCount = 1;
+
+    failedTestCommands = 0;
+    failedTests = 0;
+    orderByHistory = false;
+    maxFailures = 0;
+    jitterCount = 0;
+    jitterSum = 0;
+    jitterMax = 0;
+    logEnabled = false;
+    receivedMessages = 0;
+    matchEvaluations = 0;
+
     clearSettings();
 }
 
@@ -113,13 +299,15 @@ void DLTTestRobot::start()
 
     status("connect");
 
-    tcpSocket.connectToHost("localhost",4490);    
+    qDebug() << "DLTTestRobot: connect" << host << port;
+
+    tcpSocket.connectToHost(host,port);    
 
     // if it is already connected set connected state
     if(tcpSocket.state()==QAbstractSocket::ConnectedState)
         status("connected");
 
-    connect(&timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    connect(&timeouts, SIGNAL(expired(int)), this, SLOT(expired(int)));
 }
 
 void DLTTestRobot::stop()
@@ -132,27 +320,36 @@ void DLTTestRobot::stop()
     disconnect(&tcpSocket, SIGNAL(hostFound()), this, SLOT(hostFound()));
     disconnect(&tcpSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(error(QAbstractSocket::SocketError)));
 
-    timer.stop();
-    disconnect(&timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    timeouts.clear();
+    disconnect(&timeouts, SIGNAL(expired(int)), this, SLOT(expired(int)));
 
-    testNum = -1;
-    commandNum = -1;
+    clearLanes();
+    state = Finished;
 
     status("stopped");
 }
 
 void DLTTestRobot::clearSettings()
 {
-    timer.stop();
+    stopStateTimer();
+
+    clearLanes();
+    state = Finished;
 
-    testNum = -1;
-    commandNum = -1;
+    readyTimeout = 3000;
+    measureDownsampling = 0;
+    host = "localhost";
+    port = 4490;
 }
 
 void DLTTestRobot::writeSettings(QXmlStreamWriter &xml)
 {
     /* Write project settings */
     xml.writeStartElement(QString("DLTTestRobot"));
+        xml.writeTextElement("readyTimeout",QString("%1").arg(readyTimeout));
+        xml.writeTextElement("measureDownsampling",QString("%1").arg(measureDownsampling));
+        xml.writeTextElement("host",host);
+        xml.writeTextElement("port",QString("%1").arg(port));
     xml.writeEndElement(); // DLTTestRobot
 }
 
@@ -174,7 +371,23 @@ void DLTTestRobot::readSettings(const QString &filename)
           {
               if(isDLTTestRobot)
               {
-
+                  /* Project settings */
+                  if(xml.name() == QString("readyTimeout"))
+                  {
+                      readyTimeout = xml.readElementText().toInt();
+                  }
+                  if(xml.name() == QString("measureDownsampling"))
+                  {
+                      measureDownsampling = xml.readElementText().toInt();
+                  }
+                  if(xml.name() == QString("host"))
+                  {
+                      host = xml.readElementText();
+                  }
+                  if(xml.name() == QString("port"))
+                  {
+                      port = xml.readElementText().toUShort();
+                  }
               }
               else if(xml.name() == QString("DLTTestRobot"))
               {
@@ -205,99 +418,109 @@ void DLTTestRobot::readyRead()
     {
         QString text = QString(tcpSocket.readLine());
 
-        if(text.size()>0 && commandNum!=-1 && testNum!=-1)
+        if(text.startsWith("ready ") && (state==Prerun || state==Postrun))
+        {
+            // DLT Viewer has processed all commands sent before the ready request
+            if(text.simplified()==QString("ready %1").arg(readyRequest))
+            {
+                qDebug() << "DLTTestRobot: ready" << readyRequest;
+                stopStateTimer();
+                stateExpired();
+            }
+        }
+        else if(text.size()>0)
         {
             text.chop(1);
+            receivedMessages++;
 
             // line is not empty
             //qDebug() << "DltTestRobot: readLine" << text;
 
-            QStringList list = text.split(' ');
+            // the filter of the live log is evaluated here, only matching lines are sent to the view
+            if(logEnabled && (logFilter.isEmpty() || text.contains(logFilter,Qt::CaseInsensitive)))
+                logLines.append(text);
+
+            if(state!=Running)
+                continue;
 
-            QString currentCommand;
-            if(testNum>=0 && testNum<tests.size())
-                currentCommand= tests[testNum].at(commandNum);
-            QStringList listCommand = currentCommand.split(' ');
+            QStringList list = text.split(' ');
 
-            if(listCommand.size()>=7 && list.size()>=5 && listCommand[0]=="find" && listCommand[3]==list[0] && listCommand[4]==list[1] && listCommand[5]==list[2])
+            // all lanes share the same input stream
+            for(int num=0;num<lanes.size() && state==Running;num++)
             {
-                if(listCommand[1]=="equal")
+                DLTTestLane *lane = lanes[num];
+                if(!lane->finished && lane->waiting)
                 {
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    //qDebug() << "DltTestRobot: find equal" << listCommand.join(' ');
-                    if(text.contains(listCommand.join(' ')))
-                    {
-                        emit this->report(text);
-                        qDebug() << "DltTestRobot: find equal matches";
-                        timer.stop();
-
-                        successTestCommand();
-                    }
+                    matchEvaluations++;
+                    matchLine(lane,text,list);
                 }
-                else if(listCommand[1]=="unequal")
-                {
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    listCommand.removeAt(0);
-                    //qDebug() << "DltTestRobot: find unequal" << listCommand.join(' ');
-                    if(text.contains(listCommand.join(' ')))
-                    {
-                        emit this->report(text);
-                        qDebug() << "DltTestRobot: find unequal matches";
-                        timer.stop();
+            }
+        }
+    }
 
-                        failedTestCommand();
-                    }
-                }
-                else if(listCommand[1]=="greater" && listCommand[6]==list[3])
-                {
-                    float value = list[4].toFloat();
-                    float commandValue = listCommand[7].toFloat();
-                    //qDebug() << "DltTestRobot: find greater" << commandValue;
-                    if(value>commandValue)
-                    {
-                        emit this->report(list[4]);
-                        qDebug() << "DltTestRobot: find greater matches";
-                        timer.stop();
+    // lines of the live log are sent once for all received lines
+    if(!logLines.isEmpty())
+    {
+        emit received(logLines);
+        logLines.clear();
+    }
+}
 
-                        successTestCommand();
-                    }
-                }
-                else if(listCommand[1]=="smaller" && listCommand[6]==list[3])
-                {
-                    float value = list[4].toFloat();
-                    float commandValue = listCommand[7].toFloat();
-                    //qDebug() << "DltTestRobot: find smaller" << commandValue;
-                    if(value<commandValue)
-                    {
-                        emit this->report(list[4]);
-                        qDebug() << "DltTestRobot: find smaller matches";
-                        timer.stop();
+void DLTTestRobot::matchLine(DLTTestLane *lane, const QString &text, const QStringList &list)
+{
+    const DLTTestCommand &current = lane->current;
 
-                        successTestCommand();
-                    }
-                }
-            }
-            else if(listCommand.size()==7 && list.size()>=5 &&  listCommand[0]=="measure" && listCommand[2]==list[0] && listCommand[3]==list[1] && listCommand[4]==list[2] && listCommand[5]==list[3])
-            {
-                qDebug() << "DltTestRobot: measure" << listCommand[6] << list[4];
-                emit this->report(QString("Measure %1 %2").arg(listCommand[6]).arg(list[4]));
-                emit this->reportSummary(QString("Measure %1 %2").arg(listCommand[6]).arg(list[4]));
-                timer.stop();
+    if(list.size()<5 || current.ecuId!=list[0] || current.appId!=list[1] || current.ctxId!=list[2])
+        return;
 
-                successTestCommand();
-            }
+    bool matched = false;
+    QString reportText = text;
+
+    switch(current.type)
+    {
+    case DLTTestCommand::FindEqual:
+        //qDebug() << "DltTestRobot: find equal" << current.pattern;
+        matched = text.contains(current.pattern);
+        break;
+    case DLTTestCommand::FindUnequal:
+        //qDebug() << "DltTestRobot: find unequal" << current.pattern;
+        matched = text.contains(current.pattern);
+        break;
+    case DLTTestCommand::FindGreater:
+        //qDebug() << "DltTestRobot: find greater" << current.value;
+        matched = current.valueId==list[3] && list[4].toFloat()>current.value;
+        reportText = list[4];
+        break;
+    case DLTTestCommand::FindSmaller:
+        //qDebug() << "DltTestRobot: find smaller" << current.value;
+        matched = current.valueId==list[3] && list[4].toFloat()<current.value;
+        reportText = list[4];
+        break;
+    case DLTTestCommand::Measure:
+        matched = current.valueId==list[3];
+        reportText = QString("Measure %1 %2").arg(current.pattern).arg(list[4]);
+        if(matched)
+        {
+            laneSummary(lane,reportText);
+            database.addMeasure(tests[lane->testNum].getId(),current.pattern,list[4].toDouble());
+            emit measured(tests[lane->testNum].getId(),lane->allTestRepeatNum*lane->testRepeat+lane->testRepeatNum,current.pattern,list[4].toDouble());
         }
+        break;
+    default:
+        break;
     }
 
+    if(!matched)
+        return;
+
+    laneReport(lane,reportText);
+    qDebug() << "DltTestRobot:" << current.typeName() << "matches";
+    stopLaneTimer(lane);
+    recordCommandTiming(lane,false);
+
+    // the lane continues after the command, the result is evaluated by the lane
+    lane->base = timeouts.elapsed();
+    resumeLane(lane,true);
 }
 
 void DLTTestRobot::connected()
@@ -313,7 +536,7 @@ void DLTTestRobot::disconnected()
 
     qDebug() << "DLTTestRobot: disconnected";
 
-    tcpSocket.connectToHost("localhost",4490);
+    tcpSocket.connectToHost(host,port);
 }
 
 void DLTTestRobot::hostFound()
@@ -326,7 +549,7 @@ void DLTTestRobot::error(QAbstractSocket::SocketError socketError)
     qDebug() << "DLTTestRobot: error" << socketError;
 
     if(tcpSocket.state()==QAbstractSocket::UnconnectedState)
-        tcpSocket.connectToHost("localhost",4490);
+        tcpSocket.connectToHost(host,port);
 }
 
 void DLTTestRobot::send(QString text)
@@ -340,23 +563,115 @@ void DLTTestRobot::send(QString text)
 }
 
 QStringList DLTTestRobot::readTests(const QString &filename)
+{
+    // a suite manifest references several test files
+    if(QFileInfo(filename).suffix()=="dts")
+        return readSuite(filename);
+
+    DLTTestFile testFile = parseTests(filename);
+
+    testsFilename = filename;
+    tests = testFile.tests;
+    version = testFile.version;
+
+    return testFile.errors;
+}
+
+QStringList DLTTestRobot::readSuite(const QString &filename)
 {
     QStringList errors;
+    QStringList files;
+    QString suiteVersion;
     int lineCounter = 0;
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly))
     {
-        qDebug() << "DLTTestRobot: failed to open file" << filename;
+        qDebug() << "DLTTestRobot: failed to open suite" << filename;
         errors.append(QString("Cannot open file!"));
         return errors;
     }
 
     testsFilename = filename;
-
     tests.clear();
 
+    QDir dir = QFileInfo(filename).absoluteDir();
+    QTextStream in(&file);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine().simplified();
+        lineCounter++;
+
+        if(line.size()==0 || line.at(0)==';')
+        {
+            // empty lines and comments are ignored
+        }
+        else
+        {
+            QStringList list = line.split(' ');
+            if(list[0]=="file" && list.size()>=2)
+            {
+                list.removeAt(0);
+                files.append(dir.absoluteFilePath(list.join(' ')));
+            }
+            else if(list[0]=="version" && list.size()==2)
+            {
+                suiteVersion = list[1];
+            }
+            else
+            {
+                errors.append(QString("ERROR: Unknown command or syntac error!"));
+                errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+            }
+        }
+    }
+    file.close();
+
+    // parse all test files in parallel, the results are returned in the order of the suite
+    QList<DLTTestFile> testFiles = QtConcurrent::blockingMapped<QList<DLTTestFile> >(files,&DLTTestRobot::parseTests);
+
+    for(int num=0;num<testFiles.size();num++)
+    {
+        const DLTTestFile &testFile = testFiles[num];
+
+        if(!testFile.errors.isEmpty())
+        {
+            errors.append(QString("File %1:").arg(QFileInfo(files[num]).fileName()));
+            errors.append(testFile.errors);
+        }
+
+        tests.append(testFile.tests);
+
+        if(suiteVersion.isEmpty() && !testFile.version.isEmpty())
+            suiteVersion = testFile.version;
+    }
+
+    version = suiteVersion;
+
+    qDebug() << "DLTTestRobot: suite loaded" << files.size() << "files" << tests.size() << "tests";
+
+    return errors;
+}
+
+DLTTestFile DLTTestRobot::parseTests(const QString &filename)
+{
+    DLTTestFile result;
+    QStringList &errors = result.errors;
+    QMap<QString,DLTTest> templates;
+    int lineCounter = 0;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "DLTTestRobot: failed to open file" << filename;
+        errors.append(QString("Cannot open file!"));
+        return result;
+    }
+
+    result.filename = filename;
+
     DLTTest test;
     bool isTest=false;
+    bool isTemplate=false;
+    QMap<QString,QStringList> templateVariables;
     QTextStream in(&file);
     while (!in.atEnd())
     {
@@ -381,18 +696,18 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                errors.append(QString("ERROR: Missing command!"));
                errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
            }
-           else if(list[0]=="test")
+           else if(list[0]=="test" || list[0]=="template")
            {
                if(list.size()<2)
                {
-                   errors.append(QString("ERROR: test command must be at least 2 words!"));
+                   errors.append(QString("ERROR: %1 command must be at least 2 words!").arg(list[0]));
                    errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                }
                else if(list[1]=="id")
                {
                    if(list.size()!=3)
                    {
-                       errors.append(QString("ERROR: test id command must be exactly 3 words!"));
+                       errors.append(QString("ERROR: %1 id command must be exactly 3 words!").arg(list[0]));
                        errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                    }
                    else
@@ -405,7 +720,7 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                {
                    if(list.size()<3)
                    {
-                       errors.append(QString("ERROR: test description command must be at least 3 words!"));
+                       errors.append(QString("ERROR: %1 description command must be at least 3 words!").arg(list[0]));
                        errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                    }
                    else
@@ -420,7 +735,7 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                {
                    if(list.size()!=3)
                    {
-                       errors.append(QString("ERROR: test repeat command must be exactly 3 words!"));
+                       errors.append(QString("ERROR: %1 repeat command must be exactly 3 words!").arg(list[0]));
                        errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                    }
                    else
@@ -433,14 +748,14 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                {
                    if(list.size()!=3)
                    {
-                       errors.append(QString("ERROR: test fail command must be exactly 3 words!"));
+                       errors.append(QString("ERROR: %1 fail command must be exactly 3 words!").arg(list[0]));
                        errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                    }
                    else
                    {
                        if(list[2]!="next" && list[2]!="continue" && list[2]!="stop")
                        {
-                           errors.append(QString("ERROR: test fail command is not next, continue or stop!"));
+                           errors.append(QString("ERROR: %1 fail command is not next, continue or stop!").arg(list[0]));
                            errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                        }
                        else
@@ -450,31 +765,51 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                        }
                    }
                }
+               else if(list[1]=="lane")
+               {
+                   if(list.size()!=3)
+                   {
+                       errors.append(QString("ERROR: %1 lane command must be exactly 3 words!").arg(list[0]));
+                       errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+                   }
+                   else
+                   {
+                       qDebug() << "DLTTestRobot: lane" << list[2];
+                       test.setLane(list[2]);
+                   }
+               }
                else if(list[1]=="begin")
                {
                    if(list.size()!=2)
                    {
-                       errors.append(QString("ERROR: test begin command must be exactly 2 words!"));
+                       errors.append(QString("ERROR: %1 begin command must be exactly 2 words!").arg(list[0]));
                        errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                    }
                    else
                    {
                        qDebug() << "DLTTestRobot: begin" << test.getId();
                        isTest = true;
+                       isTemplate = (list[0]=="template");
                    }
                }
                else if(list[1]=="end")
                {
                    if(list.size()!=2)
                    {
-                       errors.append(QString("ERROR: test end command must be exactly 2 words!"));
+                       errors.append(QString("ERROR: %1 end command must be exactly 2 words!").arg(list[0]));
                        errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                    }
                    else
                    {
                        qDebug() << "DLTTestRobot: end" << test.getId();
                        isTest=false;
-                       tests.append(test);
+                       if(isTemplate)
+                       {
+                           templates.insert(test.getId(),test);
+                           templateVariables.insert(test.getId(),test.getVariables());
+                       }
+                       else
+                           result.tests.append(test);
                        test.clear();
                    }
                }
@@ -484,6 +819,66 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                    errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                }
            }
+           else if(list[0]=="instantiate")
+           {
+               // instantiate <template id> <test id> <variable>=<value> ...
+               if(isTest || list.size()<3)
+               {
+                   errors.append(QString("ERROR: instantiate command must be at least 3 words and outside of a test!"));
+                   errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+               }
+               else if(!templates.contains(list[1]))
+               {
+                   errors.append(QString("ERROR: Unknown template %1!").arg(list[1]));
+                   errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+               }
+               else
+               {
+                   // the instance shares the command list with the template
+                   DLTTest instance = templates[list[1]];
+                   QMap<QString,QString> bindings;
+                   bool valid = true;
+                   for(int num=3;num<list.size();num++)
+                   {
+                       int pos = list[num].indexOf('=');
+                       if(pos<1)
+                       {
+                           errors.append(QString("ERROR: Binding %1 must be <variable>=<value>!").arg(list[num]));
+                           errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+                           valid = false;
+                       }
+                       else
+                           bindings.insert(list[num].left(pos),list[num].mid(pos+1));
+                   }
+                   const QStringList &variables = templateVariables[list[1]];
+                   for(int num=0;num<variables.size();num++)
+                   {
+                       if(!bindings.contains(variables[num]))
+                       {
+                           errors.append(QString("ERROR: Variable %1 of template %2 is not bound!").arg(variables[num]).arg(list[1]));
+                           errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+                           valid = false;
+                       }
+                   }
+                   for(QMap<QString,QString>::const_iterator it = bindings.constBegin();it!=bindings.constEnd();++it)
+                   {
+                       if(!variables.contains(it.key()))
+                       {
+                           errors.append(QString("ERROR: Variable %1 is not used in template %2!").arg(it.key()).arg(list[1]));
+                           errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
+                           valid = false;
+                       }
+                   }
+                   if(valid)
+                   {
+                       qDebug() << "DLTTestRobot: instantiate" << list[1] << list[2];
+                       instance.setBindings(bindings);
+                       instance.setId(list[2]);
+                       instance.setDescription(instance.expand(instance.getDescription()));
+                       result.tests.append(instance);
+                   }
+               }
+           }
            else if(list[0]=="version")
            {
                 if(list.size()!=2)
@@ -492,7 +887,7 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                     errors.append(QString("=> line %1: \"%2\"").arg(lineCounter).arg(line));
                 }
                 else
-                    version = list[1];
+                    result.version = list[1];
            }
            else if(isTest)
            {
@@ -503,7 +898,7 @@ QStringList DLTTestRobot::readTests(const QString &filename)
                     (((list.size()==2 || list.size()==3)  && list[0]=="wait")) ||
                     ((list.size()>=7  && list[0]=="find" && (list[1]=="equal" || list[1]=="unequal"))) ||
                     ((list.size()>=8 && list[0]=="find" && (list[1]=="greater" || list[1]=="smaller"))) ||
-                    (list.size()>=7  && list[0]=="measure" )
+                    (list.size()==7  && list[0]=="measure" )
 
                   )
                 {
@@ -527,230 +922,613 @@ QStringList DLTTestRobot::readTests(const QString &filename)
 
     file.close();
 
-    return errors;
+    return result;
 }
 
-void DLTTestRobot::startTest(int num,int repeat)
+void DLTTestRobot::startTest(int num,int repeat,bool resume)
 {
     emit statusTests("Prerun");
-    timer.start(3000);
     state = Prerun;
+    requestReady();
 
     if(repeat<1)
         allTestRepeat = 1;
     else
         allTestRepeat = repeat;
-    allTestRepeatNum = 0;
 
     if(num<0)
     {
         allTests = true;
-        testNum = 0;
     }
     else
     {
         allTests = false;
-        testNum = num;
+    }
+
+    failedTestCommands = 0;
+    failedTests = 0;
+
+    // continue the last run from the checkpoint or start a new run
+    if(!resume || !loadCheckpoint(num))
+    {
+        createLanes(num);
+        createCheckpoint(num);
     }
 
     failed = false;
+
+    database.beginRun(testsFilename,version);
 }
 
-void DLTTestRobot::stopTest()
+void DLTTestRobot::createCheckpoint(int num)
 {
-    if(testNum != -1 && commandNum!=-1)
-    {
-        timer.stop();
+    if(checkpointFile.isOpen())
+        checkpointFile.close();
+
+    if(checkpointFilename.isEmpty())
+        return;
 
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"stopped");
+    QDir().mkpath(QFileInfo(checkpointFilename).absolutePath());
 
-        testNum = -1;
-        commandNum = -1;
+    checkpointFile.setFileName(checkpointFilename);
+    if(!checkpointFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qDebug() << "DLTTestRobot: cannot write checkpoint" << checkpointFilename;
+        return;
     }
 
-    emit statusTests("Postrun");
-    timer.start(3000);
-    state = Postrun;
+    // header with the parameters of the run and the order of the tests in each lane
+    checkpointFile.write(QString("checkpoint 2 %1 %2 %3 %4\n").arg(num).arg(allTestRepeat).arg(tests.size()).arg(testsHash()).toLatin1());
+    for(int laneNum=0;laneNum<lanes.size();laneNum++)
+    {
+        QStringList testNums;
+        for(int index=0;index<lanes[laneNum]->testNums.size();index++)
+            testNums.append(QString("%1").arg(lanes[laneNum]->testNums[index]));
+        checkpointFile.write(QString("lane %1\n").arg(testNums.join(' ')).toLatin1());
+    }
+    checkpointFile.flush();
+}
 
-    qDebug() << "DLTTestRobot: stopped test" ;
+void DLTTestRobot::writeCheckpoint(DLTTestLane *lane, bool success)
+{
+    if(!checkpointFile.isOpen())
+        return;
+
+    // summary of the test is written together with its result, so a resumed run does not repeat it
+    for(int num=0;num<lane->summary.size();num++)
+        checkpointFile.write(QString("summary %1\n").arg(lane->summary[num]).toLatin1());
+    lane->summary.clear();
+
+    checkpointFile.write(QString("done %1 %2 %3 %4 %5 %6 %7\n").arg(lanes.indexOf(lane)).arg(lane->allTestRepeatNum).arg(lane->testIndex).arg(lane->testRepeatNum).arg(success?1:0).arg(failedTestCommands).arg(failedTests).toLatin1());
+    checkpointFile.flush();
 }
 
-void DLTTestRobot::runTest()
+QString DLTTestRobot::testsHash() const
 {
-    while(commandNum<commandCount)
+    // hash of the ids, parameters and commands of all tests in the order of the test file
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(int num=0;num<tests.size();num++)
     {
+        const DLTTest &test = tests[num];
+        hash.addData(QString("test %1 %2 %3 %4\n").arg(test.getId()).arg(test.getRepeat()).arg(test.getLane()).arg(test.getFail()).toUtf8());
+        QStringList commands = test.getExpandedCommands();
+        for(int command=0;command<commands.size();command++)
+            hash.addData((commands[command]+"\n").toUtf8());
+    }
+    return QString(hash.result().toHex());
+}
+
+bool DLTTestRobot::loadCheckpoint(int num)
+{
+    if(checkpointFile.isOpen())
+        checkpointFile.close();
 
-        QString currentCommand = tests[testNum].at(commandNum);
+    checkpointFile.setFileName(checkpointFilename);
+    if(checkpointFilename.isEmpty() || !checkpointFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        emit report("No checkpoint found, start new run");
+        return false;
+    }
 
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,currentCommand);
+    clearLanes();
 
-        QStringList list = currentCommand.split(' ');
+    bool valid = false;
+    QStringList summary;
+    QList<QStringList> done;
+    QTextStream in(&checkpointFile);
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        QStringList list = line.split(' ');
 
-        if(list.size()>=2 && list[0]=="wait")
+        if(list[0]=="checkpoint" && list.size()==6)
         {
-            if(list.size()==3)
+            // the checkpoint must be from the same run parameters and the same tests
+            valid = (list[1]=="2" && list[2].toInt()==num && list[3].toInt()==allTestRepeat && list[4].toInt()==tests.size() && list[5]==testsHash());
+        }
+        else if(list[0]=="lane" && valid)
+        {
+            DLTTestLane *lane = new DLTTestLane();
+            for(int index=1;index<list.size();index++)
             {
-                // Random wait
-                uint waitTime = QRandomGenerator::global()->bounded(list[1].toUInt(), list[2].toUInt());
-                qDebug() << "DLTTestRobot: start random wait timer" << waitTime;
-                timer.start(waitTime);
-                emit this->report(QString("Random Wait %1").arg(waitTime));
-                emit this->reportSummary(QString("Random Wait %1").arg(waitTime));
+                int testNum = list[index].toInt();
+                if(testNum<0 || testNum>=tests.size())
+                    valid = false;
+                else
+                    lane->testNums.append(testNum);
             }
+            if(lane->testNums.isEmpty())
+                valid = false;
             else
-                timer.start(list[1].toUInt());
-            qDebug() << "DLTTestRobot: start wait timer" << list[1].toUInt();
-            return;
+                lane->name = tests[lane->testNums[0]].getLane();
+            lanes.append(lane);
         }
-        else if(list.size()>=3 && list[0]=="find")
+        else if(list[0]=="summary" && valid)
         {
-            timer.start(list[2].toUInt());
-            qDebug() << "DLTTestRobot: start find timer" << list[2].toUInt();
-            return;
+            summary.append(line.mid(8));
         }
-        else if(list.size()>=2 && list[0]=="measure")
+        else if(list[0]=="done" && list.size()==8 && valid)
         {
-            timer.start(list[1].toUInt());
-            qDebug() << "DLTTestRobot: start measure timer" << list[1].toUInt();
-            return;
+            // a damaged line must not index outside of the lanes and tests
+            int laneNum = list[1].toInt();
+            int testIndex = list[3].toInt();
+            int testRepeatNum = list[4].toInt();
+            if(laneNum<0 || laneNum>=lanes.size() || list[2].toInt()<0 || testIndex<0 || testIndex>=lanes[laneNum]->testNums.size() ||
+               testRepeatNum<0 || testRepeatNum>=tests[lanes[laneNum]->testNums[testIndex]].getRepeat())
+            {
+                valid = false;
+                continue;
+            }
+            done.append(list);
         }
-        else
+        // a last incomplete line after a crash is ignored
+    }
+    checkpointFile.close();
+
+    if(!valid || lanes.isEmpty())
+    {
+        emit report("Checkpoint does not match the tests, start new run");
+        clearLanes();
+        return false;
+    }
+
+    // continue each lane after its last completed test
+    for(int num=0;num<done.size();num++)
+    {
+        const QStringList &list = done[num];
+        DLTTestLane *lane = lanes[list[1].toInt()];
+        lane->allTestRepeatNum = list[2].toInt();
+        lane->testIndex = list[3].toInt();
+        lane->testRepeatNum = list[4].toInt();
+        failedTestCommands = list[6].toInt();
+        failedTests = list[7].toInt();
+
+        int testNum = lane->testNums[lane->testIndex];
+        emit resumedResult(testNum,lane->testRepeatNum,tests[testNum].getRepeat(),list[5]=="1");
+
+        lane->testRepeatNum++;
+        if(lane->testRepeatNum>=tests[testNum].getRepeat())
         {
-            send(currentCommand);
+            lane->testRepeatNum = 0;
+            lane->testIndex++;
+            if(lane->testIndex>=lane->testNums.size())
+            {
+                lane->testIndex = 0;
+                lane->allTestRepeatNum++;
+                if(lane->allTestRepeatNum>=allTestRepeat)
+                    lane->finished = true;
+            }
         }
-        commandNum++;
     }
-    // end reached
-    if(failed)
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"failed");
-    else
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"end success");
 
-    qDebug() << "DLTTestRobot: end test" << tests[testNum].getId();
+    for(int num=0;num<summary.size();num++)
+        emit reportSummary(summary[num]);
 
-    nextTest();
+    emit report(QString("Resume run after %1 completed tests").arg(done.size()));
+    qDebug() << "DLTTestRobot: resume after" << done.size() << "completed tests";
+
+    // append further results to the checkpoint
+    if(!checkpointFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        qDebug() << "DLTTestRobot: cannot write checkpoint" << checkpointFilename;
+
+    return true;
 }
 
-bool DLTTestRobot::nextTest()
+void DLTTestRobot::createLanes(int num)
 {
-    testRepeatNum++;
-    if(testRepeatNum<testRepeat)
+    clearLanes();
+
+    for(int testNum=0;testNum<tests.size();testNum++)
     {
-        commandCount = tests[testNum].size();
-        commandNum = 0;
-        failed = false;
+        if(num>=0 && testNum!=num)
+            continue;
 
-        qDebug() << "DLTTestRobot: start test" << tests[testNum].getId();
+        // when running all tests only every shardCount test is executed by this instance
+        if(num<0 && shardCount>1 && (testNum%shardCount)!=shardIndex)
+            continue;
 
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"started");
+        // tests with the same lane name are executed one after the other
+        DLTTestLane *lane = 0;
+        for(int laneNum=0;laneNum<lanes.size();laneNum++)
+        {
+            if(lanes[laneNum]->name==tests[testNum].getLane())
+                lane = lanes[laneNum];
+        }
+        if(!lane)
+        {
+            lane = new DLTTestLane();
+            lane->name = tests[testNum].getLane();
+            lanes.append(lane);
+        }
+        lane->testNums.append(testNum);
+    }
 
-        runTest();
-        return true;
+    if(num<0 && orderByHistory)
+    {
+        for(int laneNum=0;laneNum<lanes.size();laneNum++)
+            orderTests(lanes[laneNum]->testNums);
     }
 
-    if(allTests)
+    qDebug() << "DLTTestRobot: lanes" << lanes.size();
+}
+
+void DLTTestRobot::orderTests(QList<int> &testNums)
+{
+    // recently failed tests first, then the shortest tests, otherwise keep the order of the file
+    std::stable_sort(testNums.begin(),testNums.end(),[this](int a, int b)
     {
-        testNum++;
-        if(testNum<testCount)
-        {
-            testRepeat = tests[testNum].getRepeat();
-            testRepeatNum = 0;
+        DLTTestHistoryEntry entryA = history.entry(tests[a].getId());
+        DLTTestHistoryEntry entryB = history.entry(tests[b].getId());
 
-            commandCount = tests[testNum].size();
-            commandNum = 0;
-            failed = false;
+        if(entryA.failScore!=entryB.failScore)
+            return entryA.failScore>entryB.failScore;
 
-            qDebug() << "DLTTestRobot: start test" << tests[testNum].getId();
+        return entryA.meanDuration<entryB.meanDuration;
+    });
+}
 
-            command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"started");
+void DLTTestRobot::clearLanes()
+{
+    for(int num=0;num<lanes.size();num++)
+    {
+        stopLaneTimer(lanes[num]);
+        delete lanes[num];
+    }
+    lanes.clear();
+}
 
-            runTest();
-            return true;
+void DLTTestRobot::stopTest()
+{
+    if(state==Running)
+    {
+        DLTTestLane *lastLane = 0;
+        for(int num=0;num<lanes.size();num++)
+        {
+            stopLaneTimer(lanes[num]);
+            if(!lanes[num]->finished)
+                lastLane = lanes[num];
+            lanes[num]->finished = true;
         }
+
+        if(lastLane)
+            laneCommand(lastLane,"stopped");
+        else
+            command(0,allTestRepeat,0,0,-1,-1,0,"stopped");
     }
 
-    allTestRepeatNum++;
-    if(allTestRepeatNum<allTestRepeat)
+    postrun();
+
+    qDebug() << "DLTTestRobot: stopped test" ;
+}
+
+void DLTTestRobot::laneCommand(DLTTestLane *lane, const QString &text)
+{
+    command(lane->allTestRepeatNum,allTestRepeat,lane->testRepeatNum,lane->testRepeat,lane->testNum,lane->commandNum,lane->commandCount,text);
+}
+
+void DLTTestRobot::laneReport(DLTTestLane *lane, const QString &text)
+{
+    // prefix reports of named lanes, as the output of the lanes is interleaved
+    if(lane->name.isEmpty())
+        emit report(text);
+    else
+        emit report(QString("[%1] %2").arg(lane->name).arg(text));
+}
+
+void DLTTestRobot::laneSummary(DLTTestLane *lane, const QString &text)
+{
+    lane->summary.append(text);
+    emit reportSummary(text);
+}
+
+void DLTTestRobot::startLaneTest(DLTTestLane *lane)
+{
+    lane->testNum = lane->testNums[lane->testIndex];
+    lane->commandCount = tests[lane->testNum].size();
+    lane->commandNum = 0;
+    lane->failed = false;
+    lane->testStart = timeouts.elapsed();
+    lane->summary.clear();
+
+    qDebug() << "DLTTestRobot: start test" << tests[lane->testNum].getId() << "lane" << lane->name;
+
+    laneCommand(lane,"started");
+}
+
+DLTLaneTask DLTTestRobot::runLane(DLTTestLane *lane)
+{
+    // the lane starts at the beginning or at the position of the checkpoint
+    for(;lane->allTestRepeatNum<allTestRepeat;lane->allTestRepeatNum++)
     {
-        if(allTests)
+        for(;lane->testIndex<lane->testNums.size();lane->testIndex++)
         {
-            testNum = 0;
-        }
+            lane->testRepeat = tests[lane->testNums[lane->testIndex]].getRepeat();
 
-        testRepeat = tests[testNum].getRepeat();
-        testRepeatNum = 0;
+            for(;lane->testRepeatNum<lane->testRepeat;lane->testRepeatNum++)
+            {
+                startLaneTest(lane);
 
-        commandCount = tests[testNum].size();
-        commandNum = 0;
-        failed = false;
+                bool stopAll = false;
+                for(;lane->commandNum<lane->commandCount;lane->commandNum++)
+                {
+                    // the lane was stopped by a signal handler while executing commands
+                    if(lane->finished)
+                        co_return;
 
-        qDebug() << "DLTTestRobot: start test" << tests[testNum].getId();
+                    lane->current = DLTTestCommand(tests[lane->testNum].at(lane->commandNum));
+                    lane->commandStart = timeouts.elapsedMs();
+                    const DLTTestCommand &current = lane->current;
 
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"started");
+                    laneCommand(lane,current.text);
 
-        runTest();
-        return true;
+                    // the lane is suspended until the DLT message is received or the timer expired
+                    bool success = true;
+                    switch(current.type)
+                    {
+                    case DLTTestCommand::Send:
+                        send(current.text);
+                        recordCommandTiming(lane,false);
+                        break;
+                    case DLTTestCommand::Wait:
+                        qDebug() << "DLTTestRobot: start wait timer" << current.time;
+                        co_await wait(lane,current.time);
+                        break;
+                    case DLTTestCommand::WaitRandom:
+                    {
+                        // Random wait
+                        uint waitTime = QRandomGenerator::global()->bounded((uint)current.time,(uint)current.timeMax);
+                        qDebug() << "DLTTestRobot: start random wait timer" << waitTime;
+                        laneReport(lane,QString("Random Wait %1").arg(waitTime));
+                        laneSummary(lane,QString("Random Wait %1").arg(waitTime));
+                        co_await wait(lane,waitTime);
+                        break;
+                    }
+                    case DLTTestCommand::FindEqual:
+                    case DLTTestCommand::FindGreater:
+                    case DLTTestCommand::FindSmaller:
+                        qDebug() << "DLTTestRobot: start find timer" << current.time;
+                        success = co_await find(lane,current.time);
+                        break;
+                    case DLTTestCommand::FindUnequal:
+                        qDebug() << "DLTTestRobot: start find timer" << current.time;
+                        success = !co_await find(lane,current.time);
+                        break;
+                    case DLTTestCommand::Measure:
+                        // measure continues after the timeout
+                        qDebug() << "DLTTestRobot: start measure timer" << current.time;
+                        co_await find(lane,current.time);
+                        break;
+                    }
+
+                    if(success)
+                        continue;
+
+                    failedTestCommands++;
+                    failed = true;
+                    lane->failed = true;
+
+                    if(tests[lane->testNum].getFail()=="continue")
+                    {
+                        // continue with current test job
+                        laneReport(lane,"Command FAILED, but continue");
+                        qDebug() << "DLTTestRobot: fail continue current test" ;
+                    }
+                    else if(tests[lane->testNum].getFail()=="stop")
+                    {
+                        // stop all tests in all lanes
+                        laneReport(lane,"Command FAILED, stop all tests");
+                        qDebug() << "DLTTestRobot: fail stop all tests" ;
+                        stopAll = true;
+                        break;
+                    }
+                    else /* tests[lane->testNum].getFail()=="next" */
+                    {
+                        // default, run next test
+                        laneReport(lane,"Command FAILED, next test");
+                        qDebug() << "DLTTestRobot: fail run next test";
+                        break;
+                    }
+                }
+
+                qDebug() << "DLTTestRobot: end test" << tests[lane->testNum].getId();
+
+                // the maximum number of failed tests stops all lanes
+                if(!endTest(lane,!lane->failed))
+                    co_return;
+
+                if(stopAll)
+                {
+                    stopAllLanes(lane);
+                    co_return;
+                }
+            }
+            lane->testRepeatNum = 0;
+        }
+        lane->testIndex = 0;
     }
 
-    command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"end");
+    // lane finished, wait until all lanes are finished
+    lane->finished = true;
+    qDebug() << "DLTTestRobot: lane done" << lane->name;
+
+    for(int num=0;num<lanes.size();num++)
+    {
+        if(!lanes[num]->finished)
+            co_return;
+    }
 
-    testNum = -1;
-    commandNum = -1;
+    laneCommand(lane,"end");
 
     qDebug() << "DLTTestRobot: all tests done" ;
 
-    emit statusTests("Postrun");
-    timer.start(3000);
-    state = Postrun;
+    postrun();
+}
 
-    return false;
+DLTTestRobot::LaneAwaiter DLTTestRobot::wait(DLTTestLane *lane, qint64 timeout)
+{
+    return LaneAwaiter(this,lane,timeout,false);
 }
 
-void DLTTestRobot::timeout()
+DLTTestRobot::LaneAwaiter DLTTestRobot::find(DLTTestLane *lane, qint64 timeout)
 {
-    timer.stop();
+    return LaneAwaiter(this,lane,timeout,true);
+}
 
-    qDebug() << "DLTTestRobot: timer expired";
+void DLTTestRobot::suspend(DLTTestLane *lane, qint64 timeout, bool listen)
+{
+    // the lane waits for the timeout and, when listening, for a DLT message matching the current command
+    startLaneTimer(lane,timeout);
+    lane->waiting = listen;
+}
 
-    if(state==Prerun)
-    {
-        state = Running;
-        emit statusTests("Running");
+void DLTTestRobot::resumeLane(DLTTestLane *lane, bool matched)
+{
+    lane->waiting = false;
+    lane->matched = matched;
+    lane->task.resume();
+}
 
-        testCount = tests.size();
+bool DLTTestRobot::endTest(DLTTestLane *lane, bool success)
+{
+    if(success)
+    {
+        laneCommand(lane,"end success");
+    }
+    else
+    {
+        laneCommand(lane,"failed");
+        failedTests++;
+    }
 
-        testRepeat = tests[testNum].getRepeat();
-        testRepeatNum = 0;
+    history.record(tests[lane->testNum].getId(),success,timeouts.elapsed()-lane->testStart);
+    testTimings[tests[lane->testNum].getId()].add(timeouts.elapsed()-lane->testStart);
+    database.addResult(tests[lane->testNum].getId(),lane->testRepeatNum,success,timeouts.elapsed()-lane->testStart);
+    writeCheckpoint(lane,success);
 
-        commandCount = tests[testNum].size();
-        commandNum = 0;
+    // stop the run after the maximum number of failed tests
+    if(!success && maxFailures>0 && failedTests>=maxFailures)
+    {
+        laneReport(lane,QString("Maximum number of %1 failed tests reached, stop all tests").arg(maxFailures));
+        qDebug() << "DLTTestRobot: maximum failures reached";
 
-        failedTestCommands = 0;
+        stopAllLanes(lane);
+        return false;
+    }
 
-        qDebug() << "DLTTestRobot: start test" << tests[testNum].getId();
+    return true;
+}
 
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"started");
+void DLTTestRobot::stopAllLanes(DLTTestLane *lane)
+{
+    laneCommand(lane,"end");
 
-        runTest();
+    for(int num=0;num<lanes.size();num++)
+    {
+        stopLaneTimer(lanes[num]);
+        lanes[num]->finished = true;
     }
-    else if(state==Running)
+
+    postrun();
+}
+
+void DLTTestRobot::postrun()
+{
+    // keep the history of this run for the ordering of the next runs
+    history.save();
+    database.endRun(failedTests,failedTestCommands,commandTimings);
+
+    if(checkpointFile.isOpen())
+        checkpointFile.close();
+
+    emit statusTests("Postrun");
+    state = Postrun;
+    requestReady();
+}
+
+void DLTTestRobot::requestReady()
+{
+    // the DLT Viewer answers when the file is created, the ECUs are connected and the filters are applied,
+    // the timeout is used when the DLT Viewer does not answer
+    readyRequest++;
+    send(QString("ready %1").arg(readyRequest));
+    startStateTimer(readyTimeout);
+}
+
+void DLTTestRobot::expired(int id)
+{
+    if(id<0)
+        stateExpired();
+    else if(id<lanes.size())
+        laneExpired(lanes[id]);
+}
+
+void DLTTestRobot::stateExpired()
+{
+    stateTimeout = 0;
+
+    qDebug() << "DLTTestRobot: timer expired";
+
+    if(state==Prerun)
     {
-        QString currentCommand = tests[testNum].at(commandNum);
-        QStringList list = currentCommand.split(' ');
+        state = Running;
+        emit statusTests("Running");
+
+        jitterCount = 0;
+        jitterSum = 0;
+        jitterMax = 0;
+        commandTimings.clear();
+        testTimings.clear();
+        findUsage.clear();
+        lastMatchTimes.clear();
 
-        if(list.size()>=1 && list[0]!="wait" && list[0]!= "measure")
+        bool finished = true;
+        for(int num=0;num<lanes.size();num++)
         {
-            if(list[1]=="unequal")
-                successTestCommand();
-            else
-                failedTestCommand();
+            if(!lanes[num]->finished)
+                finished = false;
+        }
+
+        if(finished)
+        {
+            command(0,allTestRepeat,0,0,-1,-1,0,"end");
 
+            postrun();
             return;
         }
 
-        commandNum++;
-        runTest();
+        // start all lanes, they run independent of each other
+        for(int num=0;num<lanes.size() && state==Running;num++)
+        {
+            DLTTestLane *lane = lanes[num];
 
+            // lanes start at the beginning or at the position of the checkpoint
+            if(lane->finished)
+                continue;
+
+            lane->base = timeouts.elapsed();
+            lane->task = runLane(lane);
+            lane->task.resume();
+        }
     }
     else if(state==Postrun)
     {
@@ -759,54 +1537,223 @@ void DLTTestRobot::timeout()
     }
 }
 
-void DLTTestRobot::successTestCommand()
+void DLTTestRobot::laneExpired(DLTTestLane *lane)
 {
-    commandNum++;
-    runTest();
+    lane->timeout = 0;
+
+    if(lane->finished || state!=Running)
+        return;
+
+    qDebug() << "DLTTestRobot: lane timer expired" << lane->name;
+
+    // measure the delay of the expiry against the scheduled deadline
+    double jitter = timeouts.elapsedMs() - lane->deadline;
+    jitterCount++;
+    jitterSum += jitter;
+    if(jitter>jitterMax)
+        jitterMax = jitter;
+    laneReport(lane,QString("Timer %1 ms jitter %2 ms").arg(lane->requested).arg(jitter,0,'f',3));
+
+    recordCommandTiming(lane,true);
+
+    // the next deadline is based on the scheduled and not on the actual expiry
+    lane->base = lane->deadline;
+
+    resumeLane(lane,false);
 }
 
-void DLTTestRobot::failedTestCommand()
+void DLTTestRobot::startLaneTimer(DLTTestLane *lane, qint64 delay)
 {
-    failedTestCommands++;
-    failed = true;
+    // deadlines are calculated from the monotonic base of the lane,
+    // so consecutive waits do not accumulate the latency of each timer
+    lane->requested = delay;
+    lane->deadline = lane->base + delay;
 
-    if(tests[testNum].getFail()=="continue")
-    {
-        // continue with current test job
-        //command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"failed");
-        emit report("Command FAILED, but continue");
-        qDebug() << "DLTTestRobot: fail continue current test" ;
+    stopLaneTimer(lane);
+    lane->timeout = timeouts.add(lane->deadline,lanes.indexOf(lane));
+}
 
-        commandNum++;
-        runTest();
-    }
-    else if(tests[testNum].getFail()=="stop")
+void DLTTestRobot::stopLaneTimer(DLTTestLane *lane)
+{
+    lane->waiting = false;
+    if(lane->timeout)
+        timeouts.cancel(lane->timeout);
+    lane->timeout = 0;
+}
+
+void DLTTestRobot::startStateTimer(qint64 delay)
+{
+    stopStateTimer();
+    stateTimeout = timeouts.add(timeouts.elapsed()+delay,-1);
+}
+
+void DLTTestRobot::stopStateTimer()
+{
+    if(stateTimeout)
+        timeouts.cancel(stateTimeout);
+    stateTimeout = 0;
+}
+
+void DLTTestRobot::setHistoryFilename(const QString &filename)
+{
+    history.load(filename);
+}
+
+void DLTTestRobot::setDatabaseFilename(const QString &filename)
+{
+    database.open(filename);
+}
+
+void DLTTestRobot::setReportDirectory(const QString &directory)
+{
+    // load the results of previous runs, each shard has its own history
+    QString baseName = directory+"/"+QFileInfo(testsFilename).baseName();
+    if(shardCount>1)
+        baseName += QString("_Shard%1").arg(shardIndex+1);
+    setHistoryFilename(baseName+"_History.xml");
+    setCheckpointFilename(baseName+"_Checkpoint.txt");
+    setDatabaseFilename(directory+"/DLTTestRobot_Runs.sqlite");
+}
+
+bool DLTTestRobot::getOrderByHistory() const
+{
+    return orderByHistory;
+}
+
+void DLTTestRobot::setOrderByHistory(bool value)
+{
+    orderByHistory = value;
+}
+
+int DLTTestRobot::getMaxFailures() const
+{
+    return maxFailures;
+}
+
+void DLTTestRobot::setMaxFailures(int value)
+{
+    maxFailures = value;
+}
+
+const QString &DLTTestRobot::getCheckpointFilename() const
+{
+    return checkpointFilename;
+}
+
+void DLTTestRobot::setCheckpointFilename(const QString &filename)
+{
+    checkpointFilename = filename;
+}
+
+void DLTTestRobot::setShard(int index, int count)
+{
+    if(count<1 || index<0 || index>=count)
     {
-        // stop all tests
-        emit report("Command FAILED, stop all tests");
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"failed");
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"end");
+        shardIndex = 0;
+        shardCount = 1;
+        return;
+    }
+
+    shardIndex = index;
+    shardCount = count;
+}
+
+int DLTTestRobot::getReadyTimeout() const
+{
+    return readyTimeout;
+}
 
-        testNum = -1;
-        commandNum = -1;
+void DLTTestRobot::setReadyTimeout(int value)
+{
+    readyTimeout = value;
+}
 
-        qDebug() << "DLTTestRobot: fail stop all tests" ;
+void DLTTestRobot::setLogEnabled(bool enabled)
+{
+    logEnabled = enabled;
+}
 
-        emit statusTests("Postrun");
-        timer.start(3000);
-        state = Postrun;
+void DLTTestRobot::setLogFilter(const QString &filter)
+{
+    logFilter = filter;
+}
+
+int DLTTestRobot::getMeasureDownsampling() const
+{
+    return measureDownsampling;
+}
+
+void DLTTestRobot::setMeasureDownsampling(int value)
+{
+    measureDownsampling = value;
+}
+
+void DLTTestRobot::recordCommandTiming(DLTTestLane *lane, bool timedOut)
+{
+    const DLTTestCommand &current = lane->current;
+    double duration = timeouts.elapsedMs() - lane->commandStart;
+
+    commandTimings[current.typeName()].add(duration);
+
+    // how much of the timeout a find or measure needed until it matched
+    if(!timedOut && current.time>0 && current.type!=DLTTestCommand::Send && current.type!=DLTTestCommand::Wait && current.type!=DLTTestCommand::WaitRandom)
+    {
+        QString key = QString("%1 step %2 %3").arg(tests[lane->testNum].getId()).arg(lane->commandNum).arg(current.typeName());
+        double usage = duration/current.time;
+        if(!findUsage.contains(key) || usage>findUsage[key])
+            findUsage[key] = usage;
+
+        lastMatchTimes.append(duration);
+        if(lastMatchTimes.size()>10)
+            lastMatchTimes.removeFirst();
     }
-    else /* tests[testNum].getFail()=="next" */
+}
+
+QStringList DLTTestRobot::getTimingSummary() const
+{
+    QStringList list;
+
+    list.append("Timing per command type:");
+    QMapIterator<QString,DLTTimingStatistics> commandIterator(commandTimings);
+    while(commandIterator.hasNext())
     {
-        // default, run next test
-        emit report("Command FAILED, next test");
-        command(allTestRepeatNum,allTestRepeat,testRepeatNum,testRepeat,testNum,commandNum,commandCount,"failed");
+        commandIterator.next();
+        list.append(QString("  %1: %2").arg(commandIterator.key()).arg(commandIterator.value().toString()));
+    }
 
-        qDebug() << "DLTTestRobot: fail run next test";
+    list.append("Timing per test:");
+    QMapIterator<QString,DLTTimingStatistics> testIterator(testTimings);
+    while(testIterator.hasNext())
+    {
+        testIterator.next();
+        list.append(QString("  %1: %2").arg(testIterator.key()).arg(testIterator.value().toString()));
+    }
 
-        nextTest();
+    list.append("Matches close to timeout (more than 80% of timeout):");
+    QMapIterator<QString,double> usageIterator(findUsage);
+    while(usageIterator.hasNext())
+    {
+        usageIterator.next();
+        if(usageIterator.value()>=0.8)
+            list.append(QString("  %1: %2% of timeout").arg(usageIterator.key()).arg(usageIterator.value()*100,0,'f',1));
     }
 
+    return list;
+}
+
+int DLTTestRobot::getJitterCount() const
+{
+    return jitterCount;
+}
+
+double DLTTestRobot::getJitterMean() const
+{
+    return jitterCount>0?jitterSum/jitterCount:0;
+}
+
+double DLTTestRobot::getJitterMax() const
+{
+    return jitterMax;
 }
 
 int DLTTestRobot::getFailedTestCommands() const
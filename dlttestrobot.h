@@ -20,6 +20,14 @@
 #include <QXmlStreamReader>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QFile>
+#include <QMap>
+
+#include "dltlanetask.h"
+#include "dlttimeoutmanager.h"
+#include "dlttesthistory.h"
+#include "dltrundatabase.h"
+#include "dlttimingstatistics.h"
 
 class DLTTest
 {
@@ -40,24 +48,114 @@ public:
     int size() { return commands.size(); }
 
     void append(const QString &text) {  commands.append(text); }
-    QString at(int num) { return commands[num]; }
+    QString at(int num) { return bindings.isEmpty() ? commands[num] : expand(commands[num]); }
 
     int getRepeat() const;
     void setRepeat(int value);
 
     const QStringList &getCommands() const;
+    QStringList getExpandedCommands() const;
 
     const QString &getFail() const;
     void setFail(const QString &newFail);
 
+    const QString &getLane() const;
+    void setLane(const QString &newLane);
+
+    // Template instances share the command list of their template
+    // and only store the variable bindings, commands are expanded on access
+    const QMap<QString,QString> &getBindings() const;
+    void setBindings(const QMap<QString,QString> &value);
+    QStringList getVariables() const;
+    QString expand(const QString &text) const;
+
 private:
     QString id;
     QString fail;
+    QString lane;
     QString description;
     QStringList commands;
+    QMap<QString,QString> bindings;
     int repeat;
 };
 
+class DLTTestFile
+{
+public:
+    QString filename;
+    QString version;
+    QList<DLTTest> tests;
+    QStringList errors;
+};
+
+// Test command parsed when it is executed, the lanes wait on the parsed commands
+class DLTTestCommand
+{
+public:
+    DLTTestCommand();
+    explicit DLTTestCommand(const QString &line);
+
+    enum Type {Send,Wait,WaitRandom,FindEqual,FindUnequal,FindGreater,FindSmaller,Measure};
+
+    QString typeName() const;
+
+    Type type;
+    QString text;
+
+    qint64 time;    // wait time, minimum of random wait or timeout in ms
+    qint64 timeMax; // maximum of random wait in ms
+
+    QString ecuId;
+    QString appId;
+    QString ctxId;
+    QString valueId;
+    QString pattern; // text to find or description of measure
+    float value;
+};
+
+// Execution state of a lane, tests in different lanes run concurrently
+class DLTTestLane
+{
+public:
+    DLTTestLane() : testIndex(0), testNum(-1), testRepeat(1), testRepeatNum(0), commandCount(0), commandNum(-1), allTestRepeatNum(0), failed(false), finished(false), waiting(false), matched(false), commandStart(0), testStart(0), base(0), deadline(0), requested(0), timeout(0) {}
+
+    QString name;
+    QList<int> testNums; // tests of this lane in execution order
+
+    int testIndex;
+    int testNum;
+
+    int testRepeat;
+    int testRepeatNum;
+
+    int commandCount;
+    int commandNum;
+
+    int allTestRepeatNum;
+
+    bool failed;
+    bool finished;
+
+    // coroutine executing the tests of the lane
+    DLTLaneTask task;
+
+    // current command, the lane is suspended while waiting for a DLT message or timeout
+    DLTTestCommand current;
+    bool waiting;
+    bool matched; // result of the last find, false when the timer expired
+    double commandStart; // monotonic start of the current command in ms
+
+    qint64 testStart;
+    QStringList summary; // summary of the current test, written to the checkpoint at the end of the test
+
+    // scheduling base and deadline of the current timer in ms of the timeout manager clock
+    qint64 base;
+    qint64 deadline;
+    qint64 requested;
+
+    quint64 timeout;
+};
+
 class DLTTestRobot : public QObject
 {
     Q_OBJECT
@@ -73,6 +171,9 @@ public:
     void readSettings(const QString &filename);
 
     QStringList readTests(const QString &filename);
+    QStringList readSuite(const QString &filename);
+
+    static DLTTestFile parseTests(const QString &filename);
 
     void send(QString text);
 
@@ -81,7 +182,7 @@ public:
     QString testDescription(int num) { if(num>=0 && num<tests.length()) return tests[num].getDescription(); else return QString(); }
     int testSize(int num) { if(num>=0 && num<tests.length()) return tests[num].size(); else return 0; }
 
-    void startTest(int num = -1,int repeat = 1);
+    void startTest(int num = -1,int repeat = 1,bool resume = false);
     void stopTest();
 
     bool getFailed() const;
@@ -96,6 +197,55 @@ public:
 
     int getFailedTestCommands() const;
 
+    // journal of the completed tests to resume an interrupted run
+    const QString &getCheckpointFilename() const;
+    void setCheckpointFilename(const QString &filename);
+
+    // DLT Viewer connection
+    const QString &getHost() const { return host; }
+    void setHost(const QString &value) { host = value; }
+    unsigned short getPort() const { return port; }
+    void setPort(unsigned short value) { port = value; }
+
+    // part of all tests executed by this instance, when the tests are distributed to several instances
+    void setShard(int index, int count);
+    int getShardIndex() const { return shardIndex; }
+    int getShardCount() const { return shardCount; }
+
+    // maximum time to wait for the DLT Viewer to be ready before and after the tests
+    int getReadyTimeout() const;
+    void setReadyTimeout(int value);
+
+    // live log of the received lines
+    void setLogEnabled(bool enabled);
+    bool getLogEnabled() const { return logEnabled; }
+    void setLogFilter(const QString &filter);
+    const QString &getLogFilter() const { return logFilter; }
+
+    int getMeasureDownsampling() const;
+    void setMeasureDownsampling(int value);
+
+    // ordering of the tests by the results of previous runs
+    void setHistoryFilename(const QString &filename);
+    void setDatabaseFilename(const QString &filename);
+    void setReportDirectory(const QString &directory);
+    bool getOrderByHistory() const;
+    void setOrderByHistory(bool value);
+    int getMaxFailures() const;
+    void setMaxFailures(int value);
+
+    int getJitterCount() const;
+    double getJitterMean() const;
+    double getJitterMax() const;
+
+    QStringList getTimingSummary() const;
+
+    // counters for the performance monitor
+    quint64 getReceivedMessages() const { return receivedMessages; }
+    quint64 getMatchEvaluations() const { return matchEvaluations; }
+    qint64 getReceiveBacklog() const { return tcpSocket.bytesAvailable(); }
+    const QList<double> &getLastMatchTimes() const { return lastMatchTimes; }
+
 signals:
 
     void status(QString text);
@@ -103,6 +253,9 @@ signals:
     void report(QString text);
     void reportSummary(QString text);
     void command(int allTestRepeatNum,int allTestRepeat, int testRepeatNum,int testRepeat,int testNum, int commandNum,int commandCount, QString text);
+    void resumedResult(int testNum, int testRepeatNum, int testRepeat, bool success);
+    void measured(QString testId, int repeat, QString name, double value);
+    void received(QStringList lines);
 
 private slots:
 
@@ -112,22 +265,77 @@ private slots:
     void disconnected();
     void error(QAbstractSocket::SocketError);
 
-    void timeout();
+    void expired(int id);
 
 private:
 
-    void successTestCommand();
-    void failedTestCommand();
+    // awaitable suspending a lane until the timer expires or, when listening, a DLT message matches the current command
+    class LaneAwaiter
+    {
+    public:
+        LaneAwaiter(DLTTestRobot *robot, DLTTestLane *lane, qint64 timeout, bool listen) : robot(robot), lane(lane), timeout(timeout), listen(listen) {}
 
-    enum {Prerun,Running,Postrun,Finished} state;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) { robot->suspend(lane,timeout,listen); }
+        bool await_resume() const noexcept { return lane->matched; }
 
-    void runTest();
-    bool nextTest();
+    private:
+        DLTTestRobot *robot;
+        DLTTestLane *lane;
+        qint64 timeout;
+        bool listen;
+    };
 
-    QTimer timer;
+    enum {Prerun,Running,Postrun,Finished} state;
+
+    void createLanes(int num);
+    void orderTests(QList<int> &testNums);
+    void clearLanes();
+    void startLaneTest(DLTTestLane *lane);
+    DLTLaneTask runLane(DLTTestLane *lane);
+    LaneAwaiter wait(DLTTestLane *lane, qint64 timeout);
+    LaneAwaiter find(DLTTestLane *lane, qint64 timeout);
+    void suspend(DLTTestLane *lane, qint64 timeout, bool listen);
+    void resumeLane(DLTTestLane *lane, bool matched);
+    bool endTest(DLTTestLane *lane, bool success);
+    void stopAllLanes(DLTTestLane *lane);
+    void postrun();
+    void requestReady();
+    void matchLine(DLTTestLane *lane, const QString &text, const QStringList &list);
+    void laneCommand(DLTTestLane *lane, const QString &text);
+    void laneReport(DLTTestLane *lane, const QString &text);
+    void laneSummary(DLTTestLane *lane, const QString &text);
+    void createCheckpoint(int num);
+    bool loadCheckpoint(int num);
+    QString testsHash() const;
+    void writeCheckpoint(DLTTestLane *lane, bool success);
+    void startLaneTimer(DLTTestLane *lane, qint64 delay);
+    void stopLaneTimer(DLTTestLane *lane);
+    void startStateTimer(qint64 delay);
+    void stopStateTimer();
+    void stateExpired();
+    void laneExpired(DLTTestLane *lane);
+    void recordCommandTiming(DLTTestLane *lane, bool timedOut);
+
+    // all timers of the states and lanes
+    DLTTimeoutManager timeouts;
+    quint64 stateTimeout;
+
+    int readyTimeout;
+    int measureDownsampling;
+
+    bool logEnabled;
+    QString logFilter;
+    QStringList logLines;
+    int readyRequest;
     unsigned int watchDogCounter,watchDogCounterLast;
 
     QTcpSocket tcpSocket;
+    QString host;
+    unsigned short port;
+
+    int shardIndex;
+    int shardCount;
 
     QList<DLTTest> tests;
 
@@ -136,20 +344,35 @@ private:
     QString version;
 
     int allTestRepeat;
-    int allTestRepeatNum;
 
     bool allTests;
-    int testCount;
-    int testNum;
-
-    int testRepeat;
-    int testRepeatNum;
 
-    int commandCount;
-    int commandNum;
+    QList<DLTTestLane*> lanes;
 
     bool failed;
     int failedTestCommands;
+    int failedTests;
+
+    QString checkpointFilename;
+    QFile checkpointFile;
+
+    DLTTestHistory history;
+    DLTRunDatabase database;
+    bool orderByHistory;
+    int maxFailures;
+
+    int jitterCount;
+    double jitterSum;
+    double jitterMax;
+
+    // timing of commands and tests of the current run
+    QMap<QString,DLTTimingStatistics> commandTimings;
+    QMap<QString,DLTTimingStatistics> testTimings;
+    QMap<QString,double> findUsage; // maximum part of the timeout used until the command matched
+    QList<double> lastMatchTimes; // time in ms until the last finds and measures matched
+
+    quint64 receivedMessages;
+    quint64 matchEvaluations;
 
 };
 
@@ -0,0 +1,170 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestrunner.cpp
+ * @licence end@
+ */
+
+#include "dlttestrunner.h"
+
+#include <QSettings>
+#include <QFileInfo>
+#include <QDebug>
+
+DLTTestRunner::DLTTestRunner(QObject *parent) : QObject(parent)
+    , dltTestRobot(this)
+    , testReport(&dltTestRobot,&dltMiniServer)
+    , performanceMonitor(&dltTestRobot,&testReport)
+{
+    performanceInterval = 0;
+
+    dltTestRobot.clearSettings();
+    dltMiniServer.clearSettings();
+
+    connect(&dltTestRobot, SIGNAL(statusTests(QString)), this, SLOT(statusTests(QString)));
+    connect(&performanceMonitor, SIGNAL(updated(QString)), this, SLOT(performance(QString)));
+}
+
+DLTTestRunner::~DLTTestRunner()
+{
+    disconnect(&dltTestRobot, SIGNAL(statusTests(QString)), this, SLOT(statusTests(QString)));
+
+    dltTestRobot.stop();
+    dltMiniServer.stop();
+}
+
+void DLTTestRunner::loadSettings(const QString &configuration)
+{
+    QString filename = configuration;
+
+    // use the autoload settings from registry, when no configuration is provided
+    if(filename.isEmpty())
+    {
+        QSettings settings;
+        if(settings.value("autoload/checked").toBool())
+            filename = settings.value("autoload/filename").toString();
+    }
+
+    if(filename.isEmpty())
+        return;
+
+    qDebug() << "DLTTestRunner: load settings" << filename;
+    dltTestRobot.readSettings(filename);
+    dltMiniServer.readSettings(filename);
+}
+
+void DLTTestRunner::setViewer(const QString &host, unsigned short port)
+{
+    if(!host.isEmpty())
+        dltTestRobot.setHost(host);
+    if(port!=0)
+        dltTestRobot.setPort(port);
+}
+
+void DLTTestRunner::setServerPort(unsigned short port)
+{
+    // overrides the DLT Mini Server port of the configuration, each instance on a host needs its own port
+    if(port!=0)
+        dltMiniServer.setPort(port);
+}
+
+void DLTTestRunner::setShard(int index, int count)
+{
+    dltTestRobot.setShard(index,count);
+}
+
+void DLTTestRunner::setPerformanceInterval(int seconds)
+{
+    performanceInterval = seconds;
+}
+
+bool DLTTestRunner::start(const QString &testsFilename, const QString &testId, int repeat, const QString &reportFilename, bool detailLog, bool dltFile)
+{
+    QString filename = testsFilename;
+
+    // use the autoload tests from registry, when no tests are provided
+    if(filename.isEmpty())
+    {
+        QSettings settings;
+        filename = settings.value("autoloadTests/filename").toString();
+    }
+
+    QStringList errors = dltTestRobot.readTests(filename);
+    if(!errors.isEmpty())
+    {
+        qDebug() << "DLTTestRunner: loading test cases failed:" << errors;
+        return false;
+    }
+    if(dltTestRobot.size()==0)
+    {
+        qDebug() << "DLTTestRunner: no tests to run in" << filename;
+        return false;
+    }
+
+    // select a single test by id
+    int num = -1;
+    if(!testId.isEmpty())
+    {
+        for(int index=0;index<dltTestRobot.size();index++)
+        {
+            if(dltTestRobot.testId(index)==testId)
+            {
+                num = index;
+                break;
+            }
+        }
+        if(num<0)
+        {
+            qDebug() << "DLTTestRunner: test not found" << testId;
+            return false;
+        }
+    }
+
+    // history, checkpoint and run database
+    dltTestRobot.setReportDirectory("reports");
+
+    // start communication
+    dltTestRobot.start();
+    dltMiniServer.start();
+    if(!dltMiniServer.isListening())
+        qDebug() << "DLTTestRunner: DLT Mini Server cannot listen on port" << dltMiniServer.getPort() << ", no test events are sent";
+
+    // create report, new DLT file and connect all ECUs
+    testReport.open(num<0?QFileInfo(dltTestRobot.getTestsFilename()).baseName():testId,reportFilename,detailLog,dltFile);
+
+    if(performanceInterval>0)
+        performanceMonitor.start(performanceInterval*1000);
+
+    qDebug() << "DLTTestRunner: start tests" << filename << (num<0?QString("all"):testId) << "repeat" << repeat;
+    dltTestRobot.startTest(num,repeat);
+
+    return true;
+}
+
+void DLTTestRunner::statusTests(QString text)
+{
+    qDebug() << "DLTTestRunner:" << text;
+
+    if(text == "Finished")
+    {
+        performanceMonitor.stop();
+
+        // close DLT file and disconnect ECUs
+        dltTestRobot.send(QString("disconnectAllEcu"));
+        dltTestRobot.send(QString("clearFile"));
+
+        emit finished(testReport.exitCode());
+    }
+}
+
+void DLTTestRunner::performance(QString text)
+{
+    qDebug() << "DLTTestRunner:" << text;
+}
@@ -0,0 +1,66 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttestrunner.h
+ * @licence end@
+ */
+
+#ifndef DLTTESTRUNNER_H
+#define DLTTESTRUNNER_H
+
+#include <QObject>
+
+#include "dlttestrobot.h"
+#include "dltminiserver.h"
+#include "dlttestreport.h"
+#include "dltperformancemonitor.h"
+
+// Runs tests without user interface on a QCoreApplication
+class DLTTestRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DLTTestRunner(QObject *parent = nullptr);
+    ~DLTTestRunner();
+
+    // load the configuration file or the autoload settings, when no configuration is provided
+    void loadSettings(const QString &configuration);
+
+    void setViewer(const QString &host, unsigned short port);
+    void setServerPort(unsigned short port);
+    void setShard(int index, int count);
+
+    // print the performance of the test robot every interval seconds, 0 disables the output
+    void setPerformanceInterval(int seconds);
+
+    // start the communication and run all tests or the test with the id, returns false when no test can be run
+    bool start(const QString &testsFilename, const QString &testId, int repeat, const QString &reportFilename, bool detailLog, bool dltFile);
+
+    DLTTestRobot &getTestRobot() { return dltTestRobot; }
+
+signals:
+
+    void finished(int exitCode);
+
+private slots:
+
+    void statusTests(QString text);
+    void performance(QString text);
+
+private:
+
+    DLTTestRobot dltTestRobot;
+    DLTMiniServer dltMiniServer;
+    DLTTestReport testReport;
+    DLTPerformanceMonitor performanceMonitor;
+    int performanceInterval;
+};
+
+#endif // DLTTESTRUNNER_H
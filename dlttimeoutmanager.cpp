@@ -0,0 +1,268 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttimeoutmanager.cpp
+ * @licence end@
+ */
+
+#include "dlttimeoutmanager.h"
+
+#include <QDebug>
+
+DLTTimeoutManager::DLTTimeoutManager(QObject *parent) : QObject(parent)
+{
+    slotHead.fill(-1,Slots);
+    slotTail.fill(-1,Slots);
+    freeList = -1;
+    count = 0;
+    armed = -1;
+    processing = false;
+
+    clock.start();
+    current = clock.elapsed();
+
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+DLTTimeoutManager::~DLTTimeoutManager()
+{
+    timer.stop();
+    disconnect(&timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+quint64 DLTTimeoutManager::add(qint64 deadline, int id)
+{
+    // bring the wheel up to date before calculating the slot
+    if(!processing && count==0)
+        current = clock.elapsed();
+
+    int index;
+    if(freeList!=-1)
+    {
+        index = freeList;
+        freeList = entries[index].next;
+    }
+    else
+    {
+        index = entries.size();
+        Entry entry;
+        entry.generation = 0;
+        entries.append(entry);
+    }
+
+    Entry &entry = entries[index];
+    entry.deadline = deadline;
+    entry.id = id;
+    entry.generation++;
+
+    insert(index);
+    count++;
+
+    // arm the timer again if the new deadline is before the armed one
+    if(!processing && (armed==-1 || entry.deadline<armed))
+        arm();
+
+    return ((quint64)entry.generation<<32) | (quint32)index;
+}
+
+void DLTTimeoutManager::cancel(quint64 handle)
+{
+    int index = (int)(handle & 0xffffffff);
+    quint32 generation = (quint32)(handle>>32);
+
+    if(index<0 || index>=entries.size() || entries[index].generation!=generation || entries[index].slot==-1)
+        return; // already expired or cancelled
+
+    unlink(index);
+    entries[index].next = freeList;
+    freeList = index;
+    count--;
+
+    if(count==0 && !processing)
+    {
+        timer.stop();
+        armed = -1;
+    }
+}
+
+void DLTTimeoutManager::clear()
+{
+    // keep the entries, so handles of cleared timeouts stay invalid
+    for(int slot=0;slot<Slots;slot++)
+    {
+        while(slotHead[slot]!=-1)
+        {
+            int index = slotHead[slot];
+            unlink(index);
+            entries[index].next = freeList;
+            freeList = index;
+        }
+    }
+    count = 0;
+
+    timer.stop();
+    armed = -1;
+}
+
+void DLTTimeoutManager::insert(int index)
+{
+    Entry &entry = entries[index];
+
+    qint64 expires = entry.deadline<current?current:entry.deadline;
+    qint64 delta = expires-current;
+
+    int slot;
+    if(delta < Level0Size)
+    {
+        slot = expires & (Level0Size-1);
+    }
+    else
+    {
+        slot = -1;
+        for(int level=1;level<Levels;level++)
+        {
+            int shift = Level0Bits+(level-1)*LevelBits;
+            if(delta < ((qint64)1<<(shift+LevelBits)) || level==Levels-1)
+            {
+                // timeouts beyond the range of the wheel are cascaded again from the last slot
+                if(delta >= ((qint64)1<<(shift+LevelBits)))
+                    expires = current + ((qint64)1<<(shift+LevelBits)) - 1;
+                slot = Level0Size + (level-1)*LevelSize + ((expires>>shift) & (LevelSize-1));
+                break;
+            }
+        }
+    }
+
+    // append to the slot, timeouts with the same deadline expire in the order they were added
+    entry.slot = slot;
+    entry.next = -1;
+    entry.prev = slotTail[slot];
+    if(slotTail[slot]!=-1)
+        entries[slotTail[slot]].next = index;
+    else
+        slotHead[slot] = index;
+    slotTail[slot] = index;
+}
+
+void DLTTimeoutManager::unlink(int index)
+{
+    Entry &entry = entries[index];
+
+    if(entry.prev!=-1)
+        entries[entry.prev].next = entry.next;
+    else
+        slotHead[entry.slot] = entry.next;
+    if(entry.next!=-1)
+        entries[entry.next].prev = entry.prev;
+    else
+        slotTail[entry.slot] = entry.prev;
+
+    entry.slot = -1;
+}
+
+void DLTTimeoutManager::cascade(int level, int slotIndex)
+{
+    // move all timeouts of a slot of a higher level into the lower levels
+    int slot = Level0Size + (level-1)*LevelSize + slotIndex;
+    int index = slotHead[slot];
+    slotHead[slot] = -1;
+    slotTail[slot] = -1;
+
+    while(index!=-1)
+    {
+        int next = entries[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void DLTTimeoutManager::advance(qint64 now)
+{
+    processing = true;
+
+    while(current<=now && count>0)
+    {
+        int slotIndex = current & (Level0Size-1);
+
+        // at the start of a new round cascade the higher levels
+        if(slotIndex==0)
+        {
+            for(int level=1;level<Levels;level++)
+            {
+                int shift = Level0Bits+(level-1)*LevelBits;
+                int index = (current>>shift) & (LevelSize-1);
+                cascade(level,index);
+                if(index!=0)
+                    break;
+            }
+        }
+
+        // expire all timeouts of this tick, timeouts added meanwhile for this tick are expired too
+        while(slotHead[slotIndex]!=-1)
+        {
+            int index = slotHead[slotIndex];
+            unlink(index);
+            entries[index].next = freeList;
+            freeList = index;
+            count--;
+
+            emit expired(entries[index].id);
+        }
+
+        current++;
+    }
+
+    if(count==0)
+        current = now+1;
+
+    processing = false;
+}
+
+void DLTTimeoutManager::arm()
+{
+    if(count==0)
+    {
+        timer.stop();
+        armed = -1;
+        return;
+    }
+
+    // search the next used slot of level 0, else wake up for the next cascade
+    int slotIndex = current & (Level0Size-1);
+    qint64 next = current + (Level0Size-slotIndex);
+    if(slotIndex==0)
+    {
+        // cascade of the higher levels is pending
+        next = current;
+    }
+    else
+    {
+        for(int num=slotIndex;num<Level0Size;num++)
+        {
+            if(slotHead[num]!=-1)
+            {
+                next = current + (num-slotIndex);
+                break;
+            }
+        }
+    }
+
+    armed = next;
+    qint64 remaining = next - clock.elapsed();
+    timer.start(remaining>0?remaining:0);
+}
+
+void DLTTimeoutManager::timeout()
+{
+    advance(clock.elapsed());
+    arm();
+}
@@ -0,0 +1,87 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttimeoutmanager.h
+ * @licence end@
+ */
+
+#ifndef DLTTIMEOUTMANAGER_H
+#define DLTTIMEOUTMANAGER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+// Hierarchical timer wheel with 1 ms resolution driven by a single timer.
+// Adding and cancelling a timeout is O(1), timeouts expire in deadline order.
+class DLTTimeoutManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DLTTimeoutManager(QObject *parent = nullptr);
+    ~DLTTimeoutManager();
+
+    // monotonic clock all deadlines are based on
+    qint64 elapsed() const { return clock.elapsed(); }
+    double elapsedMs() const { return clock.nsecsElapsed()/1000000.0; }
+
+    // add a timeout with an absolute deadline in ms, returns a handle to cancel it
+    quint64 add(qint64 deadline, int id);
+    void cancel(quint64 handle);
+    void clear();
+
+    int size() const { return count; }
+
+signals:
+
+    void expired(int id);
+
+private slots:
+
+    void timeout();
+
+private:
+
+    enum { Level0Bits = 8, LevelBits = 6, Levels = 4 };
+    enum { Level0Size = 1<<Level0Bits, LevelSize = 1<<LevelBits };
+    enum { Slots = Level0Size + (Levels-1)*LevelSize };
+
+    struct Entry
+    {
+        qint64 deadline;
+        int id;
+        quint32 generation;
+        int slot;
+        int prev;
+        int next;
+    };
+
+    void insert(int index);
+    void unlink(int index);
+    void cascade(int level, int slotIndex);
+    void advance(qint64 now);
+    void arm();
+
+    QElapsedTimer clock;
+    QTimer timer;
+
+    QVector<Entry> entries;
+    QVector<int> slotHead;
+    QVector<int> slotTail;
+    int freeList;
+    int count;
+
+    qint64 current; // next tick to be processed
+    qint64 armed;   // tick the timer is armed for, -1 if not armed
+    bool processing;
+};
+
+#endif // DLTTIMEOUTMANAGER_H
@@ -0,0 +1,205 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttimeserieswriter.cpp
+ * @licence end@
+ */
+
+#include "dlttimeserieswriter.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+
+// File format, all numbers little endian:
+// header:        "DTSC" quint32 version
+// string record: quint8 'S' quint8 type (0 test, 1 series) quint16 index quint32 length UTF-8 text
+// block record:  quint8 'B' quint32 rows, qint64 timestamps in ms since epoch, quint16 tests,
+//                quint32 repeats, quint16 series, double values
+static const quint32 timeSeriesVersion = 1;
+
+DLTTimeSeriesWriter::DLTTimeSeriesWriter(QObject *parent) : QObject(parent)
+{
+    downsampling = 0;
+
+    timer.setInterval(1000);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(expired()));
+}
+
+DLTTimeSeriesWriter::~DLTTimeSeriesWriter()
+{
+    close();
+}
+
+bool DLTTimeSeriesWriter::open(const QString &filename)
+{
+    close();
+
+    tests.clear();
+    series.clear();
+    pending.clear();
+
+    if(!writer.open(filename,false))
+        return false;
+
+    QByteArray data;
+    QDataStream stream(&data,QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("DTSC",4);
+    stream << timeSeriesVersion;
+    writer.write(data);
+
+    timer.start();
+
+    return true;
+}
+
+void DLTTimeSeriesWriter::close()
+{
+    if(!isOpen())
+        return;
+
+    timer.stop();
+
+    // write the values of the last downsampling intervals
+    for(QHash<QPair<quint16,quint16>,Pending>::const_iterator it = pending.constBegin();it!=pending.constEnd();++it)
+    {
+        if(it.value().count>0)
+            append(it.value().window,it.key().first,it.value().repeat,it.key().second,it.value().sum/it.value().count);
+    }
+    pending.clear();
+
+    writeBlock();
+    writer.close();
+}
+
+void DLTTimeSeriesWriter::add(const QString &test, int repeat, const QString &series, double value)
+{
+    add(QDateTime::currentMSecsSinceEpoch(),test,repeat,series,value);
+}
+
+void DLTTimeSeriesWriter::add(qint64 timestamp, const QString &test, int repeat, const QString &series, double value)
+{
+    if(!isOpen())
+        return;
+
+    quint16 testIndex = stringIndex(tests,0,test);
+    quint16 seriesIndex = stringIndex(this->series,1,series);
+
+    if(downsampling<=0)
+    {
+        append(timestamp,testIndex,repeat,seriesIndex,value);
+        return;
+    }
+
+    // average the values of each interval
+    qint64 window = timestamp - timestamp%downsampling;
+    Pending &entry = pending[qMakePair(testIndex,seriesIndex)];
+    // a new interval or a new repeat starts a new row
+    if(entry.count>0 && (entry.window!=window || entry.repeat!=repeat))
+    {
+        append(entry.window,testIndex,entry.repeat,seriesIndex,entry.sum/entry.count);
+        entry.sum = 0;
+        entry.count = 0;
+    }
+    entry.window = window;
+    entry.repeat = repeat;
+    entry.sum += value;
+    entry.count++;
+}
+
+void DLTTimeSeriesWriter::append(qint64 timestamp, quint16 test, quint32 repeat, quint16 series, double value)
+{
+    timestamps.append(timestamp);
+    testColumn.append(test);
+    repeatColumn.append(repeat);
+    seriesColumn.append(series);
+    valueColumn.append(value);
+
+    // write full blocks and do not keep values in memory for a long time
+    if(timestamps.size()>=BlockRows || QDateTime::currentMSecsSinceEpoch()-timestamps.first()>=BlockAge)
+        writeBlock();
+}
+
+void DLTTimeSeriesWriter::expired()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // write the downsampling intervals which are finished
+    if(downsampling>0)
+    {
+        for(QHash<QPair<quint16,quint16>,Pending>::iterator it = pending.begin();it!=pending.end();++it)
+        {
+            Pending &entry = it.value();
+            if(entry.count>0 && entry.window+downsampling<=now)
+            {
+                append(entry.window,it.key().first,entry.repeat,it.key().second,entry.sum/entry.count);
+                entry.sum = 0;
+                entry.count = 0;
+            }
+        }
+    }
+
+    if(!timestamps.isEmpty() && now-timestamps.first()>=BlockAge)
+        writeBlock();
+}
+
+quint16 DLTTimeSeriesWriter::stringIndex(QHash<QString,quint16> &table, quint8 type, const QString &text)
+{
+    QHash<QString,quint16>::const_iterator it = table.constFind(text);
+    if(it!=table.constEnd())
+        return it.value();
+
+    // new strings are written before the first block using them
+    quint16 index = table.size();
+    table.insert(text,index);
+
+    QByteArray utf8 = text.toUtf8();
+    QByteArray data;
+    QDataStream stream(&data,QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << (quint8)'S' << type << index << (quint32)utf8.size();
+    stream.writeRawData(utf8.constData(),utf8.size());
+    writer.write(data);
+
+    return index;
+}
+
+void DLTTimeSeriesWriter::writeBlock()
+{
+    if(timestamps.isEmpty())
+        return;
+
+    int rows = timestamps.size();
+
+    QByteArray data;
+    data.reserve(5+rows*(8+2+4+2+8));
+    QDataStream stream(&data,QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    stream << (quint8)'B' << (quint32)rows;
+    for(int num=0;num<rows;num++)
+        stream << timestamps[num];
+    for(int num=0;num<rows;num++)
+        stream << testColumn[num];
+    for(int num=0;num<rows;num++)
+        stream << repeatColumn[num];
+    for(int num=0;num<rows;num++)
+        stream << seriesColumn[num];
+    for(int num=0;num<rows;num++)
+        stream << valueColumn[num];
+    writer.write(data);
+
+    timestamps.clear();
+    testColumn.clear();
+    repeatColumn.clear();
+    seriesColumn.clear();
+    valueColumn.clear();
+}
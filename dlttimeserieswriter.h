@@ -0,0 +1,87 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttimeserieswriter.h
+ * @licence end@
+ */
+
+#ifndef DLTTIMESERIESWRITER_H
+#define DLTTIMESERIESWRITER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+
+#include "dltreportwriter.h"
+
+// Writes measured values to a binary columnar time series file.
+// The rows are collected in blocks, each block stores the columns timestamp, test, repeat, series and value one after the other.
+// With downsampling the values of each test and series are averaged over the downsampling interval.
+// A timer writes the finished intervals and blocks older than a minute, also when no further values are measured.
+class DLTTimeSeriesWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DLTTimeSeriesWriter(QObject *parent = nullptr);
+    ~DLTTimeSeriesWriter();
+
+    bool open(const QString &filename);
+    void close();
+    bool isOpen() const { return writer.isOpen(); }
+
+    // interval in ms, 0 writes all values
+    void setDownsampling(int interval) { downsampling = interval; }
+    int getDownsampling() const { return downsampling; }
+
+    void add(const QString &test, int repeat, const QString &series, double value);
+    void add(qint64 timestamp, const QString &test, int repeat, const QString &series, double value);
+
+private slots:
+
+    void expired();
+
+private:
+
+    enum { BlockRows = 4096, BlockAge = 60000 };
+
+    class Pending
+    {
+    public:
+        Pending() : window(0), repeat(0), sum(0), count(0) {}
+
+        qint64 window;
+        int repeat;
+        double sum;
+        int count;
+    };
+
+    void append(qint64 timestamp, quint16 test, quint32 repeat, quint16 series, double value);
+    quint16 stringIndex(QHash<QString,quint16> &table, quint8 type, const QString &text);
+    void writeBlock();
+
+    DLTReportWriter writer;
+    int downsampling;
+    QTimer timer;
+
+    QHash<QString,quint16> tests;
+    QHash<QString,quint16> series;
+    QHash<QPair<quint16,quint16>,Pending> pending;
+
+    QVector<qint64> timestamps;
+    QVector<quint16> testColumn;
+    QVector<quint32> repeatColumn;
+    QVector<quint16> seriesColumn;
+    QVector<double> valueColumn;
+};
+
+#endif // DLTTIMESERIESWRITER_H
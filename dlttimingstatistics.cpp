@@ -0,0 +1,100 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttimingstatistics.cpp
+ * @licence end@
+ */
+
+#include "dlttimingstatistics.h"
+
+#include <cmath>
+
+// bins start at 0.01 ms, each bin is 5% wider than the previous one
+static const double binBase = 0.01;
+static const double binFactor = 1.05;
+
+DLTTimingStatistics::DLTTimingStatistics()
+{
+    clear();
+}
+
+void DLTTimingStatistics::clear()
+{
+    count = 0;
+    sum = 0;
+    min = 0;
+    max = 0;
+    histogram.fill(0,Bins);
+}
+
+void DLTTimingStatistics::add(double value)
+{
+    if(value<0)
+        value = 0;
+
+    if(count==0 || value<min)
+        min = value;
+    if(count==0 || value>max)
+        max = value;
+    count++;
+    sum += value;
+
+    histogram[bin(value)]++;
+}
+
+double DLTTimingStatistics::percentile(double percent) const
+{
+    if(count==0)
+        return 0;
+
+    qint64 rank = (qint64)std::ceil(count*percent/100.0);
+    if(rank<1)
+        rank = 1;
+
+    qint64 sumCount = 0;
+    for(int index=0;index<Bins;index++)
+    {
+        sumCount += histogram[index];
+        if(sumCount>=rank)
+        {
+            // upper bound of the bin, but never outside of the measured range
+            double value = binUpper(index);
+            if(value>max)
+                value = max;
+            if(value<min)
+                value = min;
+            return value;
+        }
+    }
+
+    return max;
+}
+
+QString DLTTimingStatistics::toString() const
+{
+    return QString("count %1 min %2 ms mean %3 ms max %4 ms p95 %5 ms").arg(count).arg(getMin(),0,'f',3).arg(getMean(),0,'f',3).arg(getMax(),0,'f',3).arg(percentile(95),0,'f',3);
+}
+
+int DLTTimingStatistics::bin(double value)
+{
+    if(value<=binBase)
+        return 0;
+
+    int index = 1+(int)(std::log(value/binBase)/std::log(binFactor));
+    if(index>=Bins)
+        index = Bins-1;
+
+    return index;
+}
+
+double DLTTimingStatistics::binUpper(int index)
+{
+    return binBase*std::pow(binFactor,index);
+}
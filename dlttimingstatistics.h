@@ -0,0 +1,55 @@
+/**
+ * @licence app begin@
+ * Copyright (C) 2021 Alexander Wenzel
+ *
+ * This file is part of the DLT Multimeter project.
+ *
+ * \copyright This code is licensed under GPLv3.
+ *
+ * \author Alexander Wenzel <alex@eli2.de>
+ *
+ * \file dlttimingstatistics.h
+ * @licence end@
+ */
+
+#ifndef DLTTIMINGSTATISTICS_H
+#define DLTTIMINGSTATISTICS_H
+
+#include <QString>
+#include <QVector>
+
+// Minimum, mean, maximum and percentiles of durations in ms.
+// The percentiles are taken from a histogram with logarithmic bins of 5% width,
+// so the memory does not grow with the number of samples.
+class DLTTimingStatistics
+{
+public:
+    DLTTimingStatistics();
+
+    void clear();
+    void add(double value);
+
+    qint64 getCount() const { return count; }
+    double getMin() const { return count>0?min:0; }
+    double getMean() const { return count>0?sum/count:0; }
+    double getMax() const { return max; }
+    double percentile(double percent) const;
+
+    // count/min/mean/max/p95 in one line
+    QString toString() const;
+
+private:
+
+    enum { Bins = 512 };
+
+    static int bin(double value);
+    static double binUpper(int index);
+
+    qint64 count;
+    double sum;
+    double min;
+    double max;
+    QVector<qint64> histogram;
+};
+
+#endif // DLTTIMINGSTATISTICS_H
@@ -13,15 +13,41 @@
  */
 
 #include "dialog.h"
+#include "dlttestcoordinator.h"
+#include "dlttestrunner.h"
+#include "dltrundatabase.h"
+#include "dltmessageencoder.h"
 #include "version.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QTextStream>
 #include <QDebug>
 
+static bool hasOption(int argc, char *argv[], const char *name)
+{
+    // needed before the application is created, accepts "--option" and "--option=value" like QCommandLineParser
+    const QString option(name);
+    for(int num=1;num<argc;num++)
+    {
+        const QString argument = QString::fromLocal8Bit(argv[num]);
+
+        // all further arguments are positional
+        if(argument=="--")
+            break;
+
+        if(argument==option || argument.startsWith(option+"="))
+            return true;
+    }
+    return false;
+}
+
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    // the coordinator, the trend query, the headless runner and the benchmark do not need any widgets
+    bool core = hasOption(argc,argv,"--coordinator") || hasOption(argc,argv,"--trend") || hasOption(argc,argv,"--headless") || hasOption(argc,argv,"--benchmark");
+    QScopedPointer<QCoreApplication> a(core?new QCoreApplication(argc, argv):new QApplication(argc, argv));
 
     QCoreApplication::setOrganizationName("alexmucde");
     QCoreApplication::setOrganizationDomain("github.com");
@@ -38,13 +64,107 @@ int main(int argc, char *argv[])
     QCommandLineOption autostartOption("a", QCoreApplication::translate("main", "Autostart Communication"));
     parser.addOption(autostartOption);
 
+    // Options to run tests without user interaction
+    QCommandLineOption runOption("run", QCoreApplication::translate("main", "Run all tests and exit when finished"));
+    parser.addOption(runOption);
+    QCommandLineOption testsOption("tests", QCoreApplication::translate("main", "Test file to run."), "file");
+    parser.addOption(testsOption);
+    QCommandLineOption repeatOption("repeat", QCoreApplication::translate("main", "Repeat all tests."), "count", "1");
+    parser.addOption(repeatOption);
+    QCommandLineOption reportOption("report", QCoreApplication::translate("main", "Report file."), "file");
+    parser.addOption(reportOption);
+    QCommandLineOption hostOption("host", QCoreApplication::translate("main", "Host of the DLT Viewer."), "host");
+    parser.addOption(hostOption);
+    QCommandLineOption portOption("port", QCoreApplication::translate("main", "Port of the DLT Viewer."), "port");
+    parser.addOption(portOption);
+    QCommandLineOption serverPortOption("server-port", QCoreApplication::translate("main", "Port of the DLT Mini Server."), "port");
+    parser.addOption(serverPortOption);
+    QCommandLineOption shardOption("shard", QCoreApplication::translate("main", "Run only the part index/count of all tests."), "index/count");
+    parser.addOption(shardOption);
+
+    // Options to run tests without user interface
+    QCommandLineOption headlessOption("headless", QCoreApplication::translate("main", "Run the tests without user interface and exit when finished"));
+    parser.addOption(headlessOption);
+    QCommandLineOption testOption("test", QCoreApplication::translate("main", "Run only the test with this id."), "id");
+    parser.addOption(testOption);
+    QCommandLineOption detailOption("detail", QCoreApplication::translate("main", "Write the detail log."));
+    parser.addOption(detailOption);
+    QCommandLineOption dltFileOption("dlt", QCoreApplication::translate("main", "Write the DLT messages of the test robot to a DLT file next to the report."));
+    parser.addOption(dltFileOption);
+    QCommandLineOption performanceOption("performance", QCoreApplication::translate("main", "Print the performance of the test robot every interval seconds."), "seconds");
+    parser.addOption(performanceOption);
+
+    // Option Coordinator
+    QCommandLineOption coordinatorOption("coordinator", QCoreApplication::translate("main", "Distribute tests to several instances and merge the reports."), "file");
+    parser.addOption(coordinatorOption);
+
+    // Option Trend
+    QCommandLineOption trendOption("trend", QCoreApplication::translate("main", "Print the trend of all runs of the last days."), "days");
+    parser.addOption(trendOption);
+
+    // Option Benchmark
+    QCommandLineOption benchmarkOption("benchmark", QCoreApplication::translate("main", "Measure the rate of encoding DLT messages."), "count");
+    parser.addOption(benchmarkOption);
+
     // Parse the Arguments
-    parser.process(a);
+    parser.process(*a);
 
     // Stop application if help is called
     if(parser.isSet(helpOption))
             return 1;
 
+    // print trends of the run database
+    if(parser.isSet(trendOption))
+    {
+        DLTRunDatabase database;
+        if(!database.open("reports/DLTTestRobot_Runs.sqlite"))
+            return 2;
+        QTextStream out(stdout);
+        out << database.trend(parser.value(trendOption).toInt()).join('\n') << "\n";
+        return 0;
+    }
+
+    // measure the DLT message encoder
+    if(parser.isSet(benchmarkOption))
+    {
+        QTextStream out(stdout);
+        out << DLTMessageEncoder::benchmark(qMax(1,parser.value(benchmarkOption).toInt())) << "\n";
+        return 0;
+    }
+
+    // run as coordinator of several instances
+    if(parser.isSet(coordinatorOption))
+    {
+        DLTTestCoordinator coordinator;
+        QStringList errors = coordinator.readShards(parser.value(coordinatorOption));
+        if(!errors.isEmpty())
+        {
+            qDebug() << "Coordinator:" << errors;
+            return 2;
+        }
+        QObject::connect(&coordinator, &DLTTestCoordinator::finished, [](int exitCode) { QCoreApplication::exit(exitCode); });
+        if(!coordinator.start())
+            return 2;
+        return a->exec();
+    }
+
+    // run tests without user interface
+    if(parser.isSet(headlessOption))
+    {
+        DLTTestRunner runner;
+        runner.loadSettings(parser.positionalArguments().isEmpty()?QString():parser.positionalArguments().at(0));
+        runner.setViewer(parser.value(hostOption),parser.value(portOption).toUShort());
+        runner.setServerPort(parser.value(serverPortOption).toUShort());
+        QStringList shard = parser.value(shardOption).split('/');
+        if(shard.size()==2)
+            runner.setShard(shard[0].toInt(),shard[1].toInt());
+        runner.setPerformanceInterval(parser.value(performanceOption).toInt());
+        QObject::connect(&runner, &DLTTestRunner::finished, [](int exitCode) { QCoreApplication::exit(exitCode); });
+        if(!runner.start(parser.value(testsOption),parser.value(testOption),parser.value(repeatOption).toInt(),parser.value(reportOption),parser.isSet(detailOption),parser.isSet(dltFileOption)))
+            return 2;
+        return a->exec();
+    }
+
     // set command line options
     QString configuration;
     if(parser.positionalArguments().size()>=1)
@@ -55,7 +175,18 @@ int main(int argc, char *argv[])
     qDebug() << "Option: -a =" << autostart;
 
     // execute dialog
-    Dialog w(autostart,configuration);
+    Dialog w(autostart && !parser.isSet(runOption),configuration);
     w.show();
-    return a.exec();
+
+    if(parser.isSet(runOption))
+    {
+        w.setViewer(parser.value(hostOption),parser.value(portOption).toUShort());
+        w.setServerPort(parser.value(serverPortOption).toUShort());
+        QStringList shard = parser.value(shardOption).split('/');
+        if(shard.size()==2)
+            w.setShard(shard[0].toInt(),shard[1].toInt());
+        w.runTests(parser.value(testsOption),parser.value(repeatOption).toInt(),parser.value(reportOption));
+    }
+
+    return a->exec();
 }
@@ -60,20 +60,48 @@ void SettingsDialog::on_pushButtonAutoload_clicked()
 
 void SettingsDialog::restoreSettings(DLTTestRobot *dltTestRobot, DLTMiniServer *dltMiniServer)
 {
+    /* DLTTestRobot */
+    ui->lineEditHost->setText(dltTestRobot->getHost());
+    ui->lineEditTestRobotPort->setText(QString("%1").arg(dltTestRobot->getPort()));
+    ui->lineEditReadyTimeout->setText(QString("%1").arg(dltTestRobot->getReadyTimeout()));
+    ui->lineEditMeasureDownsampling->setText(QString("%1").arg(dltTestRobot->getMeasureDownsampling()));
+
     /* DLTMiniServer */
     ui->lineEditPort->setText(QString("%1").arg(dltMiniServer->getPort()));
     ui->lineEditApplicationId->setText(dltMiniServer->getApplicationId());
     ui->lineEditContextId->setText(dltMiniServer->getContextId());
+    ui->lineEditEcuId->setText(dltMiniServer->getEcuId());
+    ui->lineEditMaxClients->setText(QString("%1").arg(dltMiniServer->getMaxClients()));
+    ui->lineEditClientQueueSize->setText(QString("%1").arg(dltMiniServer->getClientQueueSize()));
+    ui->comboBoxSlowClientPolicy->setCurrentIndex(dltMiniServer->getSlowClientPolicy());
+    ui->lineEditFlushDelay->setText(QString("%1").arg(dltMiniServer->getFlushDelay()));
+    ui->comboBoxLogLevel->setCurrentIndex(dltMiniServer->getLogLevel()-DLT_LOG_FATAL);
+    ui->comboBoxStepLogLevel->setCurrentIndex(dltMiniServer->getStepLogLevel()-DLT_LOG_FATAL);
+    ui->lineEditMaxStepRate->setText(QString("%1").arg(dltMiniServer->getMaxStepRate()));
 
 
 }
 
 void SettingsDialog::backupSettings(DLTTestRobot *dltTestRobot, DLTMiniServer *dltMiniServer)
 {
+    /* DLTTestRobot */
+    dltTestRobot->setHost(ui->lineEditHost->text());
+    dltTestRobot->setPort(ui->lineEditTestRobotPort->text().toUShort());
+    dltTestRobot->setReadyTimeout(ui->lineEditReadyTimeout->text().toInt());
+    dltTestRobot->setMeasureDownsampling(ui->lineEditMeasureDownsampling->text().toInt());
+
     /* DLTMiniServer */
     dltMiniServer->setPort(ui->lineEditPort->text().toUShort());
     dltMiniServer->setApplicationId(ui->lineEditApplicationId->text());
     dltMiniServer->setContextId(ui->lineEditContextId->text());
+    dltMiniServer->setEcuId(ui->lineEditEcuId->text());
+    dltMiniServer->setMaxClients(ui->lineEditMaxClients->text().toInt());
+    dltMiniServer->setClientQueueSize(ui->lineEditClientQueueSize->text().toInt());
+    dltMiniServer->setSlowClientPolicy((DLTMiniServer::SlowClientPolicy)ui->comboBoxSlowClientPolicy->currentIndex());
+    dltMiniServer->setFlushDelay(ui->lineEditFlushDelay->text().toInt());
+    dltMiniServer->setLogLevel(ui->comboBoxLogLevel->currentIndex()+DLT_LOG_FATAL);
+    dltMiniServer->setStepLogLevel(ui->comboBoxStepLogLevel->currentIndex()+DLT_LOG_FATAL);
+    dltMiniServer->setMaxStepRate(ui->lineEditMaxStepRate->text().toInt());
 }
 
 void SettingsDialog::on_checkBoxAutostart_clicked(bool checked)